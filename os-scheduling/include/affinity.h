@@ -0,0 +1,41 @@
+#ifndef __AFFINITY_H_
+#define __AFFINITY_H_
+
+#include <atomic>
+#include "process.h"
+
+// Cache-affine dispatch: when a core pulls a process that last ran on some
+// other core, and that core is still busy, the process is parked in the
+// other core's slot instead of migrating. Its core takes it as soon as it is
+// free; if that has not happened within `wait` ms, any free core may. There
+// is one slot per core, so the queue behind a parked process keeps moving.
+//
+// Not synchronised: callers hold whatever lock guards their ready queue.
+// Deadlines are mirrored in atomics so that an idle core can see whether
+// anything is there for it without taking that lock (claimable()).
+class AffinitySlots {
+private:
+    typedef struct Slot {
+        Process *process;
+        std::atomic<uint64_t> deadline;     // time (ms) any core may take it, 0 if the slot is empty
+    } Slot;
+
+    Slot *slots;
+    uint32_t num_cores;
+    uint32_t wait;
+    std::atomic<uint32_t> num_parked;
+
+public:
+    AffinitySlots(uint32_t num_cores, uint32_t wait);
+    ~AffinitySlots();
+
+    bool enabled() const;
+    bool park(Process *p, uint64_t now);                // hold p for its last core (false if that slot is taken)
+    Process* claim(uint32_t core_id, uint64_t now);     // p parked for core_id, else the longest overdue one
+    bool claimable(uint32_t core_id, uint64_t now) const;
+    uint64_t nextDeadline() const;                      // earliest deadline (UINT64_MAX if none)
+    uint32_t parked() const;
+    void boost();                                       // MLFQ: parked processes back to the top level
+};
+
+#endif // __AFFINITY_H_
@@ -7,26 +7,54 @@
 #include <fstream>
 #include <sstream>
 
-enum ScheduleAlgorithm : uint8_t { FCFS, SJF, RR, PP };
+enum ScheduleAlgorithm : uint8_t { FCFS, SJF, RR, PP, MLFQ, CFS };
 
 typedef struct ProcessDetails {
-    uint16_t pid;
+    uint32_t pid;
     uint32_t start_time;
     uint16_t num_bursts;
     uint32_t *burst_times;
     uint8_t priority;
 } ProcessDetails;
 
+// An I/O device that serves up to `capacity` requests at once; the rest
+// wait in its queue and are started in `policy` order
+typedef struct IoDeviceSpec {
+    enum Policy : uint8_t { Fifo, ShortestFirst };
+    uint32_t capacity;
+    Policy policy;
+} IoDeviceSpec;
+
+static const uint16_t MAX_CORES = INT16_MAX;         // core ids are int16_t, -1 meaning none
+static const uint32_t MAX_PROCESSES = INT32_MAX;
+static const uint16_t BASE_CORE_SPEED = 1000;   // core speeds are in thousandths of the base speed
+
 typedef struct SchedulerConfig {
-    uint8_t cores;
+    uint16_t cores;
+    uint16_t num_core_speeds;    // entries in core_speeds (0: every core runs at BASE_CORE_SPEED)
+    uint16_t *core_speeds;      // per core speed factor (line 1: "cores speed0 speed1 ...")
+    bool speed_placement;       // place the longest bursts on the fastest free cores
     ScheduleAlgorithm algorithm;
     uint32_t context_switch;
     uint32_t time_slice;
-    uint16_t num_processes;
+    uint32_t migration_penalty; // extra ms before a process runs on a different core than last time
+    uint32_t affinity_wait;     // ms a ready process may wait for the core it last ran on (0 = any core)
+    uint8_t num_io_devices;     // entries in io_devices (0: I/O never waits for a device)
+    IoDeviceSpec *io_devices;
+    uint32_t num_processes;
     ProcessDetails *processes;
+    uint32_t *burst_storage;    // all burst times in one array (NULL if each process owns its own)
+    void *mapping;              // binary workload the burst times point into (NULL if none)
+    size_t mapping_size;
 } SchedulerConfig;
 
+ScheduleAlgorithm scheduleAlgorithmFromString(const char *name, bool *ok);
+const char* scheduleAlgorithmToString(ScheduleAlgorithm algorithm);
+
+uint16_t coreSpeed(const SchedulerConfig *config, uint32_t core_id);
+
 SchedulerConfig* readConfigFile(const char *filename);
+SchedulerConfig* readConfigFileFast(const char *filename, std::string& error);
 void deleteConfig(SchedulerConfig *config);
 
 #endif // __CONFIGREADER_H_
\ No newline at end of file
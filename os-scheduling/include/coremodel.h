@@ -0,0 +1,31 @@
+#ifndef __COREMODEL_H_
+#define __COREMODEL_H_
+
+#include <cstdio>
+#include <vector>
+#include "configreader.h"
+
+// Heterogeneous cores: burst times in a workload are ms of work on a core of
+// BASE_CORE_SPEED, and a core of speed S does S / BASE_CORE_SPEED of that
+// work per ms it runs. Time slices, context switches and every reported time
+// stay in wall ms; only how fast a running process gets through its burst
+// depends on the core.
+
+// Wall ms a core needs to do `work` ms of burst (rounded up, so it is all done)
+uint64_t runTimeOnCore(uint64_t work, uint16_t speed);
+// Burst still left after running `elapsed` wall ms of `work` on a core
+uint32_t workLeftOnCore(uint32_t work, uint64_t elapsed, uint16_t speed);
+
+// Time a core spent running processes
+typedef struct CoreUsage {
+    uint16_t speed;
+    uint64_t busy;          // ms running processes (not switching)
+    uint64_t last_busy;     // time its last process came off the core
+} CoreUsage;
+
+std::vector<CoreUsage> coreUsage(const SchedulerConfig *config);
+void recordCoreBusy(CoreUsage& usage, uint64_t burst_start, uint64_t now);
+// Utilization and makespan of each speed class (nothing for identical cores)
+void printCoreUsage(FILE *out, const std::vector<CoreUsage>& cores, uint64_t start, uint64_t makespan);
+
+#endif // __COREMODEL_H_
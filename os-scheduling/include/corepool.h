@@ -0,0 +1,138 @@
+#ifndef __COREPOOL_H_
+#define __COREPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A simulated core as a resumable task: step() does everything the core can
+// do at `now` (dispatch, run, preempt, switch) and returns the time (ms) it
+// next has to run, WAIT to sleep until it is woken, or FINISHED. `worker` is
+// the host thread running the step, for anything the core keeps per thread.
+class CoreTask {
+public:
+    static const uint64_t WAIT = UINT64_MAX - 1;
+    static const uint64_t FINISHED = UINT64_MAX;
+
+    virtual ~CoreTask() {}
+    virtual uint64_t step(uint64_t now, uint32_t worker) = 0;
+};
+
+// Resumes a waiting core before its time (new work, an interrupt, the end of
+// the run). A wake that arrives during a step makes the core step again.
+class CoreWaker {
+public:
+    virtual ~CoreWaker() {}
+    virtual void wake(uint16_t core_id) = 0;
+};
+
+// Runs core tasks on host threads until every one has FINISHED
+class CoreExecutor : public CoreWaker {
+public:
+    virtual ~CoreExecutor() {}
+    virtual uint32_t workers() const = 0;       // host threads (step()'s `worker` is below this)
+    virtual void start(const std::vector<CoreTask*>& tasks) = 0;
+    virtual void join() = 0;
+    virtual void printStats(FILE *out) const {}
+};
+
+// 1:1: every core gets a host thread of its own that sleeps between steps
+class ThreadExecutor : public CoreExecutor {
+private:
+    typedef struct Core {
+        std::mutex mutex;
+        std::condition_variable wakeup;
+        bool woken;
+    } Core;
+
+    uint32_t num_cores;
+    Core *cores;
+    std::vector<std::thread> threads;
+
+    void run(CoreTask *task, uint16_t core_id);
+
+public:
+    ThreadExecutor(uint32_t num_cores);
+    ~ThreadExecutor();
+
+    uint32_t workers() const;
+    void start(const std::vector<CoreTask*>& tasks);
+    void wake(uint16_t core_id);
+    void join();
+};
+
+// M:N: cores are multiplexed on a fixed number of host threads. Each worker
+// keeps a min-heap of (resume time, core) for the cores it last ran; a worker
+// with nothing due steals a due core from another worker's heap, and a core
+// then stays with whichever worker ran it last. A core is only ever stepped
+// by one worker at a time: every heap entry carries the core's sequence
+// number, and entries made stale by a wake or a newer resume time are
+// skipped when they come up.
+// An idle worker sleeps until its own earliest entry. Due work stuck behind
+// a worker that is busy stepping a core pokes one sleeping worker awake to
+// steal it, so host CPU follows the work rather than the pool size.
+class PoolExecutor : public CoreExecutor {
+private:
+    typedef struct Entry {
+        uint64_t time;
+        uint64_t seq;
+        uint16_t core;
+    } Entry;
+
+    struct EntryLater {
+        bool operator ()(const Entry& e1, const Entry& e2) const
+        {
+            return e1.time > e2.time;
+        }
+    };
+
+    typedef struct Worker {
+        std::mutex mutex;
+        std::condition_variable wakeup;
+        std::vector<Entry> heap;
+        bool stepping;          // running a core's step
+        bool sleeping;          // waiting on `wakeup` with nothing due
+        bool poked;             // woken to look for work to steal
+        uint64_t steps;
+        uint64_t steals;
+    } Worker;
+
+    typedef struct Core {
+        std::mutex mutex;
+        uint64_t seq;           // bumped whenever the core's pending entry changes
+        uint32_t home;          // worker whose heap holds its entry
+        bool running;
+        bool woken;             // wake() arrived during a step
+        bool finished;
+    } Core;
+
+    uint32_t num_workers;
+    Worker *pool;
+    Core *cores;
+    std::vector<CoreTask*> tasks;
+    std::vector<std::thread> threads;
+    std::atomic<uint32_t> finished;
+
+    void push(uint32_t worker, const Entry& entry);
+    bool popDue(uint32_t worker, uint64_t now, Entry *entry);
+    bool steal(uint32_t worker, uint64_t now, Entry *entry);
+    void setStepping(uint32_t worker, bool stepping);
+    void pokeIdle(uint32_t worker);
+    void runEntry(uint32_t worker, const Entry& entry);
+    void run(uint32_t worker);
+
+public:
+    PoolExecutor(uint32_t num_workers);
+    ~PoolExecutor();
+
+    uint32_t workers() const;
+    void start(const std::vector<CoreTask*>& tasks);
+    void wake(uint16_t core_id);
+    void join();
+    void printStats(FILE *out) const;
+};
+
+#endif // __COREPOOL_H_
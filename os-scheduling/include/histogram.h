@@ -0,0 +1,58 @@
+#ifndef __HISTOGRAM_H_
+#define __HISTOGRAM_H_
+
+#include <cstdio>
+#include "process.h"
+
+// Log-bucketed (HDR-style) histogram of non-negative integer values
+// Values below 32 get a bucket each; above that every power of two is split
+// into 32 equal buckets, so any recorded value is reported within ~3% while
+// the whole 64-bit range fits in a fixed 1920 counters. Recording is O(1)
+// and histograms of the same shape can be summed with merge().
+// Not thread-safe: give each thread its own and merge them afterwards.
+class LatencyHistogram {
+private:
+    static const int SUB_BITS = 5;
+    static const int SUB_BUCKETS = 1 << SUB_BITS;
+    static const int BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    uint64_t counts[BUCKETS];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t min_value;
+    uint64_t max_value;
+
+    static int bucketOf(uint64_t value);
+    static uint64_t bucketHighest(int bucket);
+
+public:
+    LatencyHistogram();
+
+    void record(uint64_t value);
+    void merge(const LatencyHistogram& other);
+
+    uint64_t count() const;
+    uint64_t min() const;
+    uint64_t max() const;
+    double mean() const;
+    uint64_t percentile(double percent) const;
+};
+
+// The scheduling latencies reported at the end of a run, all in ms:
+//  - turnaround: launch to termination
+//  - wait: total time spent ready
+//  - response: launch to first dispatch
+//  - dispatch: each stretch in the ready queue, until a core picks it up
+typedef struct SchedulingLatencies {
+    LatencyHistogram turnaround;
+    LatencyHistogram wait;
+    LatencyHistogram response;
+    LatencyHistogram dispatch;
+
+    void dispatched(const Process *p, uint64_t current_time);   // call before it is set Running
+    void terminated(const Process *p);                          // call after it is set Terminated
+    void merge(const SchedulingLatencies& other);
+    void print(FILE *out) const;
+} SchedulingLatencies;
+
+#endif // __HISTOGRAM_H_
@@ -0,0 +1,72 @@
+#ifndef __IODEVICE_H_
+#define __IODEVICE_H_
+
+#include <cstdio>
+#include <vector>
+#include "configreader.h"
+#include "histogram.h"
+#include "process.h"
+
+// One I/O device (see IoDeviceSpec). A process starting an I/O burst submits
+// it as a request; if a slot is free it is served at once, otherwise it
+// waits in a heap ordered by the device's policy (submission order, or
+// shortest burst first) until a request in service finishes.
+// Not synchronised: only the simulator loop or the monitor thread uses it.
+class IoDevice {
+private:
+    typedef struct Request {
+        Process *process;
+        uint32_t length;    // ms of service (the I/O burst)
+        uint64_t submitted;
+        uint64_t seq;       // submission order: FIFO, and the tie-breaker for shortest first
+    } Request;
+
+    // Heap order: true if r1 should be served after r2
+    struct ServedLater {
+        IoDeviceSpec::Policy policy;
+        bool operator ()(const Request& r1, const Request& r2) const
+        {
+            if (policy == IoDeviceSpec::ShortestFirst && r1.length != r2.length)
+            {
+                return r1.length > r2.length;
+            }
+            return r1.seq > r2.seq;
+        }
+    };
+
+    IoDeviceSpec spec;
+    std::vector<Request> waiting;
+    ServedLater order;
+    uint32_t in_service;
+    uint64_t next_seq;
+    uint64_t requests;
+    uint64_t service_ms;        // total ms of service started
+    size_t longest_queue;
+    LatencyHistogram queueing;  // ms from submission until service starts
+
+public:
+    IoDevice(const IoDeviceSpec& spec);
+
+    bool submit(Process *p, uint64_t now);  // true if it is served at once (its burst ends at now + burst)
+    Process* finish(uint64_t now);          // a request ended: the waiting one it starts (its burst ends at now + burst)
+    void print(FILE *out, uint32_t id, uint64_t makespan) const;
+};
+
+// The configured I/O devices. Each process does all its I/O on one of them
+// (pid modulo the number of devices); with none configured every burst is
+// served at once, as if there were a device per process.
+class IoDevices {
+private:
+    std::vector<IoDevice> devices;
+
+public:
+    IoDevices(const SchedulerConfig *config);
+
+    bool enabled() const;
+    IoDevice& deviceOf(const Process *p);
+    void print(FILE *out, uint64_t makespan) const;
+};
+
+bool parseIoDevices(const char *text, std::vector<IoDeviceSpec>& devices);
+
+#endif // __IODEVICE_H_
@@ -0,0 +1,195 @@
+#ifndef __POLICY_H_
+#define __POLICY_H_
+
+#include <algorithm>
+#include "configreader.h"
+#include "process.h"
+#include "readyqueue.h"
+
+// Scheduling policies: everything that differs between the algorithms, as
+// types the scheduler loops (the Simulator and the real-time core and
+// monitor threads) are instantiated over. Each algorithm gets its own copy
+// of those loops with the choices below fixed at compile time, so the hot
+// paths have no per-iteration algorithm checks. Only the simulator holds
+// its ready queue as a Queue, so only its queue calls are direct: the
+// real-time RunQueues still build theirs with createReadyQueue() and call
+// them through ReadyQueue*.
+//  - Queue: ready queue type, holding processes in dispatch order
+//  - TIME_SLICED: a running process is preempted once timeSlice(p, runnable)
+//    ms of CPU have passed since it was dispatched, where `runnable` counts
+//    the processes competing for that core (p included)
+//  - PRIORITY_PREEMPTION: a running process is preempted as soon as a
+//    higher priority one is ready (see PriorityTracker)
+//  - DISPATCH_BATCH: how many processes a real-time core may reserve from
+//    its queue at once (RunQueues::takeBatch(), which only batches for a
+//    lone core). Only FIFO queues batch: one core runs the next few in line
+//    in the same order either way, whereas a heap would let a better
+//    process arrive after they were reserved.
+//  - PERIODIC_BOOST: every boostInterval() ms the scheduler resets every
+//    process to the top feedback level (Process::setLevel(0), then
+//    ReadyQueue::boost())
+//  - sliceExpired(p) / blocked(p): p used up its time slice (and is about to
+//    be queued again) / p left its core for an I/O burst. Both are called by
+//    whoever owns p at that point (see runqueues.h).
+//  - ran(p, ms): p just came off its core after running for `ms`, for any
+//    reason (same caller rules; called before the two above)
+// withPolicy() maps a ScheduleAlgorithm to its policy, once, at startup.
+
+// Defaults for everything a policy does not override
+struct BasicPolicy {
+    static const bool TIME_SLICED = false;
+    static const bool PRIORITY_PREEMPTION = false;
+    static const bool PERIODIC_BOOST = false;
+    static const uint32_t DISPATCH_BATCH = 1;
+
+    uint32_t timeSlice(const Process *p, uint32_t runnable) const { return 0; }
+    void ran(Process *p, uint64_t ms) const {}
+    void sliceExpired(Process *p) const {}
+    void blocked(Process *p) const {}
+    uint32_t boostInterval() const { return 0; }
+};
+
+struct FcfsPolicy : BasicPolicy {
+    typedef FifoReadyQueue Queue;
+    static const uint32_t DISPATCH_BATCH = 4;
+
+    explicit FcfsPolicy(const SchedulerConfig *config) {}
+};
+
+struct SjfPolicy : BasicPolicy {
+    typedef HeapReadyQueue<SjfComparator> Queue;
+
+    explicit SjfPolicy(const SchedulerConfig *config) {}
+};
+
+struct RrPolicy : BasicPolicy {
+    typedef FifoReadyQueue Queue;
+    static const bool TIME_SLICED = true;
+    static const uint32_t DISPATCH_BATCH = 4;
+
+    uint32_t time_slice;
+
+    explicit RrPolicy(const SchedulerConfig *config) :
+        time_slice((config->time_slice > 0) ? config->time_slice : 1) {}
+    uint32_t timeSlice(const Process *p, uint32_t runnable) const { return time_slice; }
+};
+
+struct PpPolicy : BasicPolicy {
+    typedef HeapReadyQueue<PpComparator> Queue;
+    static const bool PRIORITY_PREEMPTION = true;
+
+    explicit PpPolicy(const SchedulerConfig *config) {}
+};
+
+// Multilevel feedback queue: processes start on the top level, where the
+// quantum is the config's time slice, and each level down doubles it.
+// Using a whole quantum drops a process one level (CPU-bound work sinks),
+// blocking for I/O lifts it one level (interactive work floats), and a
+// periodic boost back to the top keeps the bottom levels from starving.
+struct MlfqPolicy : BasicPolicy {
+    typedef MlfqReadyQueue Queue;
+    static const bool TIME_SLICED = true;
+    static const bool PERIODIC_BOOST = true;
+    static const uint32_t BOOST_QUANTA = 32;    // boost period, in top-level quanta
+
+    uint32_t quantum;   // top level (ms)
+
+    explicit MlfqPolicy(const SchedulerConfig *config) :
+        quantum((config->time_slice > 0) ? config->time_slice : 1) {}
+
+    uint32_t timeSlice(const Process *p, uint32_t runnable) const
+    {
+        return quantum << p->getLevel();
+    }
+
+    void sliceExpired(Process *p) const
+    {
+        if (p->getLevel() < Queue::LEVELS - 1)
+        {
+            p->setLevel(p->getLevel() + 1);
+        }
+    }
+
+    void blocked(Process *p) const
+    {
+        if (p->getLevel() > 0)
+        {
+            p->setLevel(p->getLevel() - 1);
+        }
+    }
+
+    uint32_t boostInterval() const
+    {
+        return quantum * BOOST_QUANTA;
+    }
+};
+
+// Completely fair scheduling: every process accumulates virtual runtime,
+// its CPU time scaled down by its weight, and the core always runs the one
+// with the least (the leftmost in CfsReadyQueue's tree). A higher priority
+// is a bigger weight, so its vruntime grows more slowly and it gets a larger
+// share of the CPU; each priority step is worth ~1.25x. Instead of a fixed
+// quantum, slices come from a target latency, the period in which every
+// runnable process on a core should get a turn, split between them in
+// proportion to weight. The config's time slice is the smallest slice
+// handed out and the latency is LATENCY_SLICES of it, so a short queue gets
+// long slices (few context switches) and a deep one degrades to RR.
+struct CfsPolicy : BasicPolicy {
+    typedef CfsReadyQueue Queue;
+    static const bool TIME_SLICED = true;
+    static const uint32_t BASE_WEIGHT = 1024;   // weight of priority 2
+    static const uint32_t LATENCY_SLICES = 8;
+
+    uint32_t granularity;   // shortest slice (ms)
+
+    explicit CfsPolicy(const SchedulerConfig *config) :
+        granularity((config->time_slice > 0) ? config->time_slice : 1) {}
+
+    static uint32_t weight(const Process *p)
+    {
+        static const uint32_t weights[5] = { 655, 820, 1024, 1277, 1586 };
+        return weights[(p->getPriority() < 5) ? p->getPriority() : 4];
+    }
+
+    uint32_t timeSlice(const Process *p, uint32_t runnable) const
+    {
+        uint64_t latency = (uint64_t)granularity * LATENCY_SLICES;
+        uint64_t slice = latency * weight(p) / ((uint64_t)BASE_WEIGHT * std::max<uint32_t>(runnable, 1));
+        return (slice > granularity) ? slice : granularity;
+    }
+
+    // vruntime is kept in 1/1024 ms of a priority 2 process
+    void ran(Process *p, uint64_t ms) const
+    {
+        p->setVruntime(p->getVruntime() + (ms * BASE_WEIGHT * 1024) / weight(p));
+    }
+};
+
+// Call `visitor.template run<Policy>()` with the policy for `algorithm`
+template <typename Visitor>
+void withPolicy(ScheduleAlgorithm algorithm, Visitor& visitor)
+{
+    switch (algorithm)
+    {
+        case ScheduleAlgorithm::SJF:
+            visitor.template run<SjfPolicy>();
+            break;
+        case ScheduleAlgorithm::RR:
+            visitor.template run<RrPolicy>();
+            break;
+        case ScheduleAlgorithm::PP:
+            visitor.template run<PpPolicy>();
+            break;
+        case ScheduleAlgorithm::MLFQ:
+            visitor.template run<MlfqPolicy>();
+            break;
+        case ScheduleAlgorithm::CFS:
+            visitor.template run<CfsPolicy>();
+            break;
+        default:
+            visitor.template run<FcfsPolicy>();
+            break;
+    }
+}
+
+#endif // __POLICY_H_
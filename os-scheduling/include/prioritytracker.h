@@ -0,0 +1,53 @@
+#ifndef __PRIORITYTRACKER_H_
+#define __PRIORITYTRACKER_H_
+
+#include <atomic>
+#include <vector>
+#include "process.h"
+
+// Incremental bookkeeping for preemptive priority scheduling
+// Ready processes are counted per priority level and running cores are kept
+// in a per-level core set, each with a bitmap of non-empty levels. The
+// highest ready priority and the lowest-priority running core are then a
+// find-first-set away, instead of a scan over every process.
+//
+// Updates come from several threads (core threads, the monitor), so every
+// field is atomic; a bitmap bit is re-derived from its level's count after
+// every change until the two agree.
+class PriorityTracker {
+public:
+    static const int LEVELS = 32;           // priorities above 31 share the top level
+
+private:
+    static const int16_t IDLE = -1;
+    static const int16_t PREEMPTING = -2;
+
+    uint16_t num_cores;
+    uint32_t core_words;                            // 64-core words per level in running_cores
+    std::atomic<uint32_t> ready_count[LEVELS];
+    std::atomic<uint32_t> ready_bitmap;
+    std::atomic<uint32_t> running_count[LEVELS];
+    std::atomic<uint32_t> running_bitmap;
+    std::atomic<uint64_t> *running_cores;           // LEVELS x core_words bitmaps: cores running that level
+    std::atomic<int16_t> *core_priority;            // per core: level, IDLE or PREEMPTING
+    std::atomic<uint32_t> num_running;
+
+    static int level(uint8_t priority);
+    static void syncBit(std::atomic<uint32_t>& bitmap, std::atomic<uint32_t>& count, int level);
+    void removeRunning(uint16_t core_id, int level);
+
+public:
+    PriorityTracker(uint16_t num_cores);
+    ~PriorityTracker();
+
+    void readyAdded(uint8_t priority);
+    void readyRemoved(uint8_t priority);
+    void runningStarted(uint16_t core_id, uint8_t priority);
+    void runningStopped(uint16_t core_id);
+
+    int highestReady() const;
+    int lowestRunning() const;
+    void selectVictims(std::vector<uint16_t>& victims);
+};
+
+#endif // __PRIORITYTRACKER_H_
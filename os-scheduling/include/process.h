@@ -1,74 +1,129 @@
 #ifndef __PROCESS_H_
 #define __PROCESS_H_
 
+#include <atomic>
 #include "configreader.h"
 
+// Field that one thread writes while others may read it at any time: relaxed
+// atomic loads/stores (plain moves on x86), used for the fields published to
+// the status display. Writes are not read-modify-write, so a field must only
+// ever have one writer at a time (see the ownership rule in runqueues.h).
+template <typename T>
+class Relaxed {
+private:
+    std::atomic<T> value;
+
+public:
+    Relaxed() {}
+    operator T() const { return value.load(std::memory_order_relaxed); }
+    Relaxed& operator=(T v) { value.store(v, std::memory_order_relaxed); return *this; }
+    Relaxed& operator+=(T v) { return *this = *this + v; }
+};
+
 // Process class
 class Process {
 public:
     enum State : uint8_t { NotStarted, Ready, Running, IO, Terminated };
 
+    // Display fields as of `current_time` (times in ms), see snapshot()
+    typedef struct Snapshot {
+        State state;
+        int16_t core;
+        int32_t turn_time;
+        int32_t wait_time;
+        int32_t cpu_time;
+        int32_t remain_time;
+    } Snapshot;
+
 private:
-    uint16_t pid;               // process ID
+    // (fields grouped by size so a Process packs without padding)
+    uint32_t *burst_times;      // CPU/IO burst array of times (in ms), a slice of the ProcessTable's arena
+    uint64_t burst_start_time;  // time that the current CPU/IO burst began
+    Relaxed<uint64_t> launch_time;  // actual time in ms (since epoch) that process was 'launched'
+    uint64_t state_start;       // start time of the process's current state
+    uint64_t vruntime;          // weighted CPU time received (CFS, see CfsPolicy)
+    Relaxed<uint64_t> last_update;  // time that turn/wait/cpu/remain times were last brought up to date
     uint32_t start_time;        // ms after program starts that process should be 'launched'
+    Relaxed<int32_t> turn_time;     // total time since 'launch' (until terminated)
+    Relaxed<int32_t> wait_time;     // total time spent in ready queue
+    Relaxed<int32_t> cpu_time;      // total time spent running on a CPU core
+    Relaxed<int32_t> remain_time;   // CPU time remaining until terminated
+    int32_t response_time;      // time from 'launch' to first being dispatched (-1 until then)
+    std::atomic<uint32_t> snapshot_seq; // seqlock over the Relaxed fields: odd while they are being changed
+    uint32_t pid;               // process ID
     uint16_t num_bursts;        // number of CPU/IO bursts
     uint16_t current_burst;     // current index into the CPU/IO burst array
-    uint32_t *burst_times;      // CPU/IO burst array of times (in ms)
+    uint16_t migrations;        // times dispatched to a different core than the previous one
+    Relaxed<uint16_t> speed;    // speed of the core it last ran on: remain_time drops by this much per ms
+    Relaxed<int16_t> core;      // CPU core currently running on
+    int16_t last_core;          // CPU core it last ran on (-1 if it has not run yet)
+    std::atomic<int16_t> run_queue; // run queue that owns the process while Ready/Running (-1 if none)
     uint8_t priority;           // process priority (0-4)
-    uint64_t burst_start_time;  // time that the current CPU/IO burst began
-    State state;                // process state
+    uint8_t level;              // feedback queue level (MLFQ, 0 = top)
+    Relaxed<State> state;       // process state
     State lastState;            //previous state of process
     bool is_interrupted;        // whether or not the process is being interrupted
-    int8_t core;                // CPU core currently running on
-    int32_t turn_time;          // total time since 'launch' (until terminated)
-    int32_t wait_time;          // total time spent in ready queue
-    int32_t cpu_time;           // total time spent running on a CPU core
-    int32_t remain_time;        // CPU time remaining until terminated
-    uint64_t launch_time;       // actual time in ms (since epoch) that process was 'launched'
-    uint64_t state_start;       // start time of the process's current state
     // you are welcome to add other private data fields here if you so choose
 
+    void beginPublish();
+    void endPublish();
+    void accumulate(uint64_t current_time);
+
 public:
     Process(ProcessDetails details, uint64_t current_time);
     ~Process();
 
-    uint16_t getPid() const;
+    uint32_t getPid() const;
     uint16_t get_current_burst_id() const;
     uint32_t getStartTime() const;
     uint8_t getPriority() const;
+    uint8_t getLevel() const;
+    uint64_t getVruntime() const;
     uint64_t getBurstStartTime() const;
     uint64_t getCurrentBurstTime() const;
     uint64_t getLaunchTime() const;
+    uint64_t getStateStart() const;
     State getState() const;
     State getLastState() const;
     bool isInterrupted() const;
     bool isLastBurst() const;
-    int8_t getCpuCore() const;
+    int16_t getCpuCore() const;
+    int16_t getLastCore() const;
+    uint16_t getMigrations() const;
     double getTurnaroundTime() const;
     double getWaitTime() const;
     double getCpuTime() const;
     double getRemainingTime() const;
+    double getResponseTime() const;
+    bool hasRun() const;
+    int16_t getRunQueue() const;
 
     void setBurstStartTime(uint64_t current_time);
     void setState(State new_state, uint64_t current_time);
     void setLastState(State state, uint64_t current_time);
-    void setCpuCore(int8_t core_num);
+    void setCpuCore(int16_t core_num);
+    void setCoreSpeed(uint16_t core_speed);
+    void setLevel(uint8_t new_level);
+    void setVruntime(uint64_t new_vruntime);
+    void setRunQueue(int16_t queue);
     void interrupt();
     void interruptHandled();
 
     void updateProcess(uint64_t current_time);
+    Snapshot snapshot(uint64_t current_time) const;
     void updateBurstTime(int burst_idx, uint32_t new_time);
     void incrementBurstIdx();
 };
 
-// Comparators: used in std::list sort() method
-// No comparator needed for FCFS or RR (ready queue never sorted)
+// Comparators: ordering policies for the ready queue heap (see readyqueue.h)
+// operator() returns true if p1 should be dispatched before p2
+// No comparator needed for FCFS or RR (ready queue is a plain FIFO)
 struct SjfComparator {
-    bool operator ()(const Process *p1, const Process *p2);
+    bool operator ()(const Process *p1, const Process *p2) const;
 };
 
 struct PpComparator {
-    bool operator ()(const Process *p1, const Process *p2);
+    bool operator ()(const Process *p1, const Process *p2) const;
 };
 
 #endif // __PROCESS_H_
\ No newline at end of file
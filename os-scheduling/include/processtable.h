@@ -0,0 +1,52 @@
+#ifndef __PROCESSTABLE_H_
+#define __PROCESSTABLE_H_
+
+#include "configreader.h"
+#include "process.h"
+
+// Storage for every Process of a run
+// The processes sit in one contiguous block, constructed in place (a Process
+// holds an atomic, so it can't be copied or moved into a vector), and their
+// burst times are slices of one arena taken over from the config rather than
+// a separate allocation each. Scans over all processes then walk memory in
+// order instead of chasing a heap pointer per process.
+class ProcessTable {
+public:
+    enum BurstOwnership : uint8_t { TakeBursts, CopyBursts };
+
+private:
+    Process *processes;
+    size_t count;
+    uint32_t *burst_storage;    // arena the burst times point into (owned, may be NULL)
+    void *mapping;              // mapped workload file they point into (owned, may be NULL)
+    size_t mapping_size;
+    size_t num_bursts;
+
+public:
+    ProcessTable(SchedulerConfig *config, uint64_t current_time, BurstOwnership ownership = TakeBursts);
+    ~ProcessTable();
+
+    size_t size() const;
+    Process& operator[](size_t i);
+    const Process& operator[](size_t i) const;
+    size_t processBytes() const;
+    size_t burstBytes() const;
+};
+
+// element access is on every scan's hot path, so it stays inline
+inline size_t ProcessTable::size() const
+{
+    return count;
+}
+
+inline Process& ProcessTable::operator[](size_t i)
+{
+    return processes[i];
+}
+
+inline const Process& ProcessTable::operator[](size_t i) const
+{
+    return processes[i];
+}
+
+#endif // __PROCESSTABLE_H_
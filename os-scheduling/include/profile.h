@@ -0,0 +1,139 @@
+#ifndef __PROFILE_H_
+#define __PROFILE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+
+// Lock and core-time profiling for the real-time scheduler (build with
+// `make PROFILE=1`, enable with --profile)
+// Every lock that the cores and the monitor share is a ProfiledMutex, and
+// every place that takes one names itself with LOCK_SITE("..."). With
+// profiling on, each acquisition records at its site how long the thread
+// waited for the lock and, on unlock, how long it was held, into histograms
+// that belong to the recording thread (merged for the report, so recording
+// takes no extra locks). Each simulated core also splits its time between
+// running a process, idling and context switching (PROFILE_ACTIVITY), and
+// the lock waits of a thread working for a core (PROFILE_CORE) are charged
+// to that core.
+//
+// Without SCHED_PROFILE the PROFILE_* macros expand to nothing, LOCK_SITE
+// to NULL, and a ProfiledMutex is a std::mutex that counts contention.
+
+// A place in the code that takes a lock (see LOCK_SITE)
+typedef struct LockSite {
+    const char *name;
+    uint32_t id;
+} LockSite;
+
+#ifdef SCHED_PROFILE
+
+namespace Profile {
+    enum Activity : uint8_t { Running, Idle, Switching, Stopped };
+
+    // start profiling a run of `num_cores` cores (before any core starts)
+    void enable(uint16_t num_cores);
+    bool enabled();
+    uint32_t registerSite(const char *name);
+    uint64_t clockNanos();
+    void acquired(const LockSite *site, uint64_t wait_ns, bool contended);
+    void released(const LockSite *site, uint64_t hold_ns);
+    // the calling thread now works for simulated core `core_id` (-1: none)
+    void setCurrentCore(int32_t core_id);
+    // core `core_id` switched to `activity` at `now` (ms, currentTime())
+    void activity(uint16_t core_id, Activity activity, uint64_t now);
+    // per-site lock statistics and per-core time (threads must have stopped)
+    void print(FILE *out);
+}
+
+// A static LockSite per expansion, registered the first time it is used
+#define LOCK_SITE(name) ([]() -> const LockSite* { \
+        static const LockSite site = { name, Profile::registerSite(name) }; return &site; }())
+#define PROFILE_CORE(core_id) Profile::setCurrentCore(core_id)
+#define PROFILE_ACTIVITY(core_id, what, now) Profile::activity(core_id, Profile::what, now)
+
+#else
+
+#define LOCK_SITE(name) ((const LockSite*)NULL)
+#define PROFILE_CORE(core_id) ((void)0)
+#define PROFILE_ACTIVITY(core_id, what, now) ((void)0)
+
+#endif // SCHED_PROFILE
+
+// std::mutex that reports whether (and how long) lock() had to wait, with
+// the wait and the hold time recorded at the locking site when profiling.
+// The site and acquisition time are kept in the mutex by whoever holds it.
+class ProfiledMutex {
+private:
+    std::mutex mutex;
+#ifdef SCHED_PROFILE
+    const LockSite *held_site;
+    uint64_t held_since;
+#endif
+
+public:
+    ProfiledMutex()
+    {
+#ifdef SCHED_PROFILE
+        held_site = NULL;
+        held_since = 0;
+#endif
+    }
+
+    // Lock at `site`: true if someone else held it (`blocked_ns`, if given,
+    // gets the time spent waiting); the clock is only read on that path
+    bool lock(const LockSite *site, uint64_t *blocked_ns)
+    {
+        bool contended = !mutex.try_lock();
+        uint64_t waited = 0;
+        if (contended)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            mutex.lock();
+            waited = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        }
+        if (blocked_ns != NULL)
+        {
+            *blocked_ns = waited;
+        }
+#ifdef SCHED_PROFILE
+        if (site != NULL && Profile::enabled())
+        {
+            Profile::acquired(site, waited, contended);
+            held_site = site;
+            held_since = Profile::clockNanos();
+        }
+#endif
+        return contended;
+    }
+
+    // BasicLockable, so std::unique_lock works (unprofiled)
+    void lock()
+    {
+        mutex.lock();
+    }
+
+    void unlock()
+    {
+#ifdef SCHED_PROFILE
+        if (held_site != NULL)
+        {
+            const LockSite *site = held_site;
+            held_site = NULL;
+            Profile::released(site, Profile::clockNanos() - held_since);
+        }
+#endif
+        mutex.unlock();
+    }
+};
+
+// Lock `mutex` at `site` for the rest of the scope
+inline std::unique_lock<ProfiledMutex> lockAt(ProfiledMutex& mutex, const LockSite *site)
+{
+    mutex.lock(site, NULL);
+    return std::unique_lock<ProfiledMutex>(mutex, std::adopt_lock);
+}
+
+#endif // __PROFILE_H_
@@ -0,0 +1,223 @@
+#ifndef __READYQUEUE_H_
+#define __READYQUEUE_H_
+
+#include <deque>
+#include <vector>
+#include "configreader.h"
+#include "process.h"
+
+// Ready queue interface: processes waiting for a CPU core, in dispatch order
+class ReadyQueue {
+public:
+    virtual ~ReadyQueue() {}
+
+    virtual void push(Process *p) = 0;
+    virtual Process* pop() = 0;                 // remove and return the next process to run
+    virtual Process* front() const = 0;         // next process to run (NULL if empty)
+    virtual bool empty() const = 0;
+    virtual size_t size() const = 0;
+    virtual void boost() {}                     // MLFQ: move everything queued to the top level
+};
+
+// FCFS and RR: plain first-in first-out queue
+class FifoReadyQueue : public ReadyQueue {
+private:
+    std::deque<Process*> queue;
+
+public:
+    void push(Process *p);
+    Process* pop();
+    Process* front() const;
+    bool empty() const;
+    size_t size() const;
+};
+
+// MLFQ: one FIFO per feedback level plus a bitmap of the non-empty levels,
+// so the next process is a find-first-set away and push/pop are O(1) for
+// any number of levels. Processes are queued at their Process::getLevel().
+class MlfqReadyQueue : public ReadyQueue {
+public:
+    static const int LEVELS = 8;
+
+private:
+    std::deque<Process*> levels[LEVELS];
+    uint32_t bitmap;        // bit L set if level L has processes
+    size_t count;
+
+public:
+    MlfqReadyQueue();
+
+    void push(Process *p);
+    Process* pop();
+    Process* front() const;
+    bool empty() const;
+    size_t size() const;
+    void boost();
+};
+
+// CFS: red-black tree keyed by virtual runtime (ties in queueing order) with
+// the leftmost node cached, so the next process is O(1) and push/remove are
+// O(log n). Nodes live in a pool and freed nodes are reused, so steady-state
+// queueing allocates nothing.
+// push() also places the process: its vruntime is raised to the queue's
+// min_vruntime, so a process that arrives or wakes from I/O runs soon but
+// cannot bank the time it was away as credit against the others.
+class CfsReadyQueue : public ReadyQueue {
+private:
+    static const uint32_t NIL = 0;  // node 0: the shared black leaf
+
+    typedef struct Node {
+        Process *process;
+        uint64_t key;       // vruntime when queued
+        uint64_t seq;       // insertion order: tie-breaker for equal keys
+        uint32_t parent;
+        uint32_t left;
+        uint32_t right;
+        bool red;
+    } Node;
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> free_nodes;
+    uint32_t root;
+    uint32_t leftmost;
+    size_t count;
+    uint64_t next_seq;
+    uint64_t min_vruntime;  // never decreases: vruntime of the last process popped
+
+    bool before(uint32_t n1, uint32_t n2) const;
+    void rotateLeft(uint32_t x);
+    void rotateRight(uint32_t x);
+    void insertFixup(uint32_t z);
+    void transplant(uint32_t u, uint32_t v);
+    void eraseFixup(uint32_t x);
+    void erase(uint32_t z);
+    uint32_t minimum(uint32_t x) const;
+
+public:
+    CfsReadyQueue();
+
+    void push(Process *p);
+    Process* pop();
+    Process* front() const;
+    bool empty() const;
+    size_t size() const;
+    uint64_t minVruntime() const;
+};
+
+// SJF and PP: binary heap ordered by `Compare` (SjfComparator or
+// PpComparator), where Compare(p1, p2) is true if p1 should run before p2.
+// Processes that compare equal are dispatched in the order they were queued.
+template <typename Compare>
+class HeapReadyQueue : public ReadyQueue {
+private:
+    typedef struct Entry {
+        Process *process;
+        uint64_t seq;       // insertion order: tie-breaker for equal keys
+    } Entry;
+
+    std::vector<Entry> heap;
+    uint64_t next_seq;
+    Compare compare;
+
+    bool before(const Entry& e1, const Entry& e2)
+    {
+        if (compare(e1.process, e2.process))
+        {
+            return true;
+        }
+        if (compare(e2.process, e1.process))
+        {
+            return false;
+        }
+        return e1.seq < e2.seq;
+    }
+
+    void siftUp(size_t idx)
+    {
+        Entry entry = heap[idx];
+        while (idx > 0)
+        {
+            size_t parent = (idx - 1) / 2;
+            if (!before(entry, heap[parent]))
+            {
+                break;
+            }
+            heap[idx] = heap[parent];
+            idx = parent;
+        }
+        heap[idx] = entry;
+    }
+
+    void siftDown(size_t idx)
+    {
+        Entry entry = heap[idx];
+        size_t n = heap.size();
+        while (true)
+        {
+            size_t child = 2 * idx + 1;
+            if (child >= n)
+            {
+                break;
+            }
+            if (child + 1 < n && before(heap[child + 1], heap[child]))
+            {
+                child++;
+            }
+            if (!before(heap[child], entry))
+            {
+                break;
+            }
+            heap[idx] = heap[child];
+            idx = child;
+        }
+        heap[idx] = entry;
+    }
+
+public:
+    HeapReadyQueue() : next_seq(0) {}
+
+    void push(Process *p)
+    {
+        Entry entry;
+        entry.process = p;
+        entry.seq = next_seq++;
+        heap.push_back(entry);
+        siftUp(heap.size() - 1);
+    }
+
+    Process* pop()
+    {
+        if (heap.empty())
+        {
+            return NULL;
+        }
+        Process *p = heap[0].process;
+        heap[0] = heap.back();
+        heap.pop_back();
+        if (!heap.empty())
+        {
+            siftDown(0);
+        }
+        return p;
+    }
+
+    Process* front() const
+    {
+        return heap.empty() ? NULL : heap[0].process;
+    }
+
+    bool empty() const
+    {
+        return heap.empty();
+    }
+
+    size_t size() const
+    {
+        return heap.size();
+    }
+};
+
+// Create the ready queue that matches a scheduling algorithm
+ReadyQueue* createReadyQueue(ScheduleAlgorithm algorithm);
+
+#endif // __READYQUEUE_H_
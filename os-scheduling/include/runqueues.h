@@ -0,0 +1,129 @@
+#ifndef __RUNQUEUES_H_
+#define __RUNQUEUES_H_
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "affinity.h"
+#include "configreader.h"
+#include "coremodel.h"
+#include "corepool.h"
+#include "process.h"
+#include "prioritytracker.h"
+#include "profile.h"
+#include "readyqueue.h"
+
+// Run queues for the real-time scheduler threads
+//  - Global: one ready queue and one lock shared by every core
+//  - PerCore: each core owns a ready queue and lock, new work goes to the
+//    least-loaded core and an idle core steals from the busiest one
+//
+// Ownership rule: a Ready or Running process belongs to exactly one queue
+// (its "home", see Process::getRunQueue()) and is only touched while holding
+// that queue's lock. NotStarted, IO and Terminated processes have no home and
+// belong to the monitor thread, which may touch them without locking.
+//
+// Cores with nothing to run park instead of spinning; adding work wakes
+// exactly one parked core (the owner of the queue if it is idle) and
+// wakeAll() releases every core at shutdown. A core is a task (see
+// corepool.h) that calls park() and returns to its executor, which the
+// wakeups then go through (setWaker(), before any core runs).
+//
+// The monitor queues a tick's arrivals and I/O completions with one
+// enqueueBatch(), and a lone core can reserve the next few processes of its
+// queue with one takeBatch(). Reserved processes stay owned by the queue (and
+// counted in its load) until the core dispatches them.
+//
+// With an affinity wait, a process goes back to the core it last ran on:
+// in Global mode a core that pulls someone else's process parks it for that
+// core (see AffinitySlots; parked processes stay owned by the queue), in
+// PerCore mode it is queued on that core's queue unless the queue is more
+// than one process busier than the least-loaded one.
+//
+// With speed placement (placeBySpeed()), new work wakes the fastest parked
+// core and PerCore mode queues it where it is expected to finish first (load
+// over core speed). Cores still pull their own work, so this only steers
+// processes towards fast cores; the simulator pairs bursts and cores exactly.
+//
+// PP in PerCore mode: the PriorityTracker picks victims across all cores, so
+// a core first takes the best process queued anywhere if it outranks the
+// front of its own queue (a preempted core would otherwise just resume the
+// process it was interrupted for).
+class RunQueues {
+public:
+    enum Mode : uint8_t { Global, PerCore };
+
+private:
+    typedef struct Queue {
+        ProfiledMutex mutex;
+        ReadyQueue *ready;
+        std::atomic<uint32_t> queued;           // processes waiting in `ready`
+        std::atomic<uint32_t> load;             // queued + running on the core
+        std::atomic<int16_t> top_priority;      // PP only: priority at the front of `ready` (-1 if empty)
+        std::atomic<uint64_t> acquisitions;     // times the lock was taken
+        std::atomic<uint64_t> contended;        // ... and had to wait for it
+        std::atomic<uint64_t> blocked_ns;       // total time spent waiting (ns)
+    } Queue;
+
+    Mode mode;
+    uint16_t num_queues;
+    Queue *queues;
+    std::atomic<uint64_t> steals;
+    PriorityTracker *priorities;            // PP only: ready/running priority levels
+    AffinitySlots *affinity;                // Global mode with an affinity wait only
+    uint32_t affinity_wait;
+    uint16_t *speeds;                       // per core, with speed placement only (else NULL)
+    CoreWaker *waker;                       // wakes cores that park()
+
+    uint16_t num_cores;
+    ProfiledMutex idle_mutex;
+    bool *idle_parked;                      // core is (still) waiting for a wakeup
+    std::atomic<uint32_t> num_idle;
+    bool stopping;
+
+    uint16_t placement(const Process *p) const;
+    Process* take(uint16_t core_id);
+    Process* popLocked(uint16_t queue);
+    Process* takeAffine(uint16_t core_id);
+    Process* steal(uint16_t core_id);
+    Process* stealFrom(uint16_t victim, uint16_t core_id);
+    int16_t outranking(uint16_t queue) const;
+    void updateTop(uint16_t queue);
+    void wakeIdle(uint16_t queue);
+    bool wakeCore(uint16_t core_id);
+
+public:
+    RunQueues(Mode mode, ScheduleAlgorithm algorithm, uint16_t num_cores, uint32_t affinity_wait);
+    ~RunQueues();
+
+    Mode getMode() const;
+    uint16_t queueOf(uint16_t core_id) const;
+
+    std::unique_lock<ProfiledMutex> lockQueue(uint16_t queue, const LockSite *site);
+    std::unique_lock<ProfiledMutex> lockProcess(Process *p, const LockSite *site);
+
+    void enqueueBatch(const std::vector<Process*>& batch);
+    void pushLocked(uint16_t queue, Process *p);
+    uint32_t takeBatch(uint16_t core_id, Process **batch, uint32_t max);
+    void release(Process *p);
+    bool hasWork(uint16_t core_id) const;
+    uint32_t runnable(uint16_t core_id) const;
+    bool park(uint16_t core_id);
+    void unpark(uint16_t core_id);
+    uint64_t parkedUntil() const;
+    void setWaker(CoreWaker *waker);
+    void wakeAll();
+    void boost();
+    void placeBySpeed(const std::vector<CoreUsage>& cores);
+    PriorityTracker* priorityTracker() const;
+
+    uint64_t lockAcquisitions() const;
+    uint64_t contendedAcquisitions() const;
+    uint64_t blockedNanos() const;
+    uint64_t stealCount() const;
+};
+
+RunQueues::Mode runQueueModeFromString(const char *name, bool *ok);
+const char* runQueueModeToString(RunQueues::Mode mode);
+
+#endif // __RUNQUEUES_H_
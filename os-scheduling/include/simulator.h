@@ -0,0 +1,50 @@
+#ifndef __SIMULATOR_H_
+#define __SIMULATOR_H_
+
+#include "configreader.h"
+#include "coremodel.h"
+#include "histogram.h"
+#include "iodevice.h"
+#include "processtable.h"
+
+// Discrete-event simulation of the scheduler on a virtual clock (ms)
+// Arrivals, burst completions, time slice expiries and context switches are
+// events in a time-ordered queue, and the clock jumps straight to the next one.
+// The event loop itself is a template over the scheduling policy (see
+// policy.h and simulator.cpp); the constructor instantiates the one for the
+// config's algorithm, so run() makes no algorithm checks of its own.
+class Simulator {
+public:
+    // Results every policy's event loop fills in
+    class Engine {
+    public:
+        uint64_t now;
+        uint64_t events_processed;
+        uint64_t preemptions;
+        SchedulingLatencies latencies;
+        std::vector<CoreUsage> usage;   // one per core
+        IoDevices io_devices;
+
+        Engine(const SchedulerConfig *config) :
+            now(0), events_processed(0), preemptions(0), io_devices(config) {}
+        virtual ~Engine() {}
+        virtual void run() = 0;
+    };
+
+private:
+    Engine *engine;
+
+public:
+    Simulator(const SchedulerConfig *config, ProcessTable& processes);
+    ~Simulator();
+
+    void run();
+    uint64_t currentTime() const;
+    uint64_t eventsProcessed() const;
+    uint64_t preemptionCount() const;
+    const SchedulingLatencies& schedulingLatencies() const;
+    const std::vector<CoreUsage>& coreUsage() const;
+    const IoDevices& ioDevices() const;
+};
+
+#endif // __SIMULATOR_H_
@@ -0,0 +1,41 @@
+#ifndef __STATUSDISPLAY_H_
+#define __STATUSDISPLAY_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "process.h"
+#include "processtable.h"
+
+// Live process table for real-time runs
+// Only processes that are ready, running or doing I/O get a row; the ones
+// not started yet or already terminated are collapsed into counts. Each
+// frame is built in one buffer and compared line by line with the previous
+// one, so only the rows that changed are rewritten (cursor movement skips the
+// rest) and the whole frame goes out in a single write. Frames closer
+// together than the refresh interval are dropped, and nothing is drawn at
+// all unless `out` is a terminal.
+class StatusDisplay {
+private:
+    FILE *out;
+    bool live;                      // `out` is a terminal
+    uint32_t interval;              // minimum ms between frames
+    uint64_t last_frame;            // time the last frame was drawn
+    bool drawn;                     // a frame is on screen
+    std::vector<std::string> lines; // what is on screen now
+    std::vector<std::string> next;  // frame being built
+    std::string buffer;             // escape codes + changed lines
+
+public:
+    StatusDisplay(FILE *out, uint32_t refresh_interval);
+
+    // draw the table as of `current_time` unless the last frame was too
+    // recent; returns whether a frame was drawn
+    bool update(ProcessTable& processes, uint64_t current_time);
+    // erase the frame on screen
+    void clear();
+};
+
+std::string processStateToString(Process::State state);
+
+#endif // __STATUSDISPLAY_H_
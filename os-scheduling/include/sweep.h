@@ -0,0 +1,40 @@
+#ifndef __SWEEP_H_
+#define __SWEEP_H_
+
+#include <cstdio>
+#include <vector>
+#include "configreader.h"
+
+// Parameter sweep: one workload simulated (on the virtual clock) under every
+// combination of algorithm, core count, time slice and context switch time.
+// Combinations are handed out to a pool of worker threads; each one builds
+// its own processes and Simulator from the shared, read-only workload, so
+// the only thing the workers share is the counter of the next combination.
+typedef struct SweepParameters {
+    std::vector<ScheduleAlgorithm> algorithms;
+    std::vector<uint32_t> cores;
+    std::vector<uint32_t> time_slices;          // ms
+    std::vector<uint32_t> context_switches;     // ms
+    uint32_t jobs;                              // worker threads (0 = one per host core)
+} SweepParameters;
+
+typedef struct SweepResult {
+    ScheduleAlgorithm algorithm;
+    uint32_t cores;
+    uint32_t time_slice;
+    uint32_t context_switch;
+    uint64_t makespan;          // ms until the last process terminated
+    double cpu_utilization;     // busy core time / (cores * makespan)
+    double throughput;          // processes completed per second
+    double avg_turnaround;      // seconds
+    double avg_wait;            // seconds
+    uint64_t events;
+} SweepResult;
+
+bool parseSweepValues(const char *text, std::vector<uint32_t>& values);
+bool parseSweepAlgorithms(const char *text, std::vector<ScheduleAlgorithm>& algorithms);
+std::vector<SweepResult> runSweep(const SchedulerConfig *workload, const SweepParameters& params);
+void printSweepCsv(FILE *out, const std::vector<SweepResult>& results);
+void printSweepJson(FILE *out, const std::vector<SweepResult>& results);
+
+#endif // __SWEEP_H_
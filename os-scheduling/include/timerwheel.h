@@ -0,0 +1,42 @@
+#ifndef __TIMERWHEEL_H_
+#define __TIMERWHEEL_H_
+
+#include <vector>
+#include "process.h"
+
+// Hierarchical timing wheel: per-process timers keyed on a deadline (ms)
+// Level 0 has one slot per ms, and every slot of level L spans a whole turn
+// of level L-1. Adding a timer is O(1); advancing the clock only visits the
+// slots that came due, and a timer is moved down a level at most LEVELS-1
+// times, so the cost does not depend on how many timers are still pending.
+class TimerWheel {
+public:
+    typedef struct Timer {
+        uint64_t deadline;  // time (ms) the timer fires
+        Process *process;   // process waiting for it
+    } Timer;
+
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const uint64_t SLOT_MASK = SLOTS - 1;
+
+    std::vector<Timer> slots[LEVELS][SLOTS];
+    std::vector<Timer> overflow;    // beyond the top level's range
+    uint64_t current;               // next ms to be processed
+    size_t count;
+    size_t level0_count;            // timers currently in level 0
+
+    void place(const Timer& timer);
+    bool cascade(int level);
+
+public:
+    TimerWheel(uint64_t start_time);
+
+    void add(uint64_t deadline, Process *p);
+    void advance(uint64_t now, std::vector<Process*>& expired);
+    size_t size() const;
+};
+
+#endif // __TIMERWHEEL_H_
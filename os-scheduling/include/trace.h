@@ -0,0 +1,61 @@
+#ifndef __TRACE_H_
+#define __TRACE_H_
+
+#include <cstdint>
+
+// Per-thread event tracing for the real-time scheduler (build with
+// `make TRACE=1`, enable with --trace=FILE)
+// Every thread that traces owns a ring buffer of fixed-size records and is
+// the only writer to it, so recording an event is a timestamp read plus a
+// 16 byte store: no locks and no shared cache lines. When a ring is full the
+// oldest records are overwritten. At exit the rings are merged into Chrome
+// trace-event JSON (chrome://tracing or ui.perfetto.dev) with one track per
+// core showing which process ran when, plus context switches and I/O.
+//
+// Without SCHED_TRACE the TRACE_* macros expand to nothing.
+
+enum TraceEvent : uint8_t {
+    TraceDispatch,      // core starts running a process
+    TracePreempt,       // core gives up an interrupted process
+    TraceBurstEnd,      // process finished its CPU burst
+    TraceIoStart,       // ... and went to I/O
+    TraceIoEnd,         // monitor: I/O burst over, process ready again
+    TraceTerminate,     // process finished its last burst
+    TraceSwitchStart,   // core begins a context switch
+    TraceSwitchEnd,
+    TraceArrival,       // monitor: process launched
+    TraceInterrupt      // monitor: asked a core to give up its process
+};
+
+typedef struct TraceRecord {
+    uint64_t timestamp;     // raw clock ticks, converted at export
+    uint32_t pid;
+    int16_t core;
+    uint8_t event;
+    uint8_t unused;
+} TraceRecord;
+
+#ifdef SCHED_TRACE
+
+namespace Trace {
+    // start tracing (before any thread registers); `capacity` is per thread
+    void enable(uint32_t capacity);
+    bool enabled();
+    // give the calling thread a ring buffer, shown as track `track`
+    void registerThread(const char *name, int track);
+    void record(TraceEvent event, uint32_t pid, int16_t core);
+    // write every thread's records as Chrome trace JSON (threads must have stopped)
+    bool writeChromeTrace(const char *filename);
+}
+
+#define TRACE_THREAD(name, track) Trace::registerThread(name, track)
+#define TRACE_EVENT(event, pid, core) Trace::record(event, pid, core)
+
+#else
+
+#define TRACE_THREAD(name, track) ((void)0)
+#define TRACE_EVENT(event, pid, core) ((void)0)
+
+#endif // SCHED_TRACE
+
+#endif // __TRACE_H_
@@ -0,0 +1,65 @@
+#ifndef __WORKLOADFILE_H_
+#define __WORKLOADFILE_H_
+
+#include <cstdio>
+#include <string>
+#include "configreader.h"
+
+// Binary workload format (version 1), all fields fixed-width little-endian:
+//
+//   header (64 bytes)
+//     char[8]  magic "OSSCHBIN"
+//     uint32   version, header size
+//     uint32   cores, algorithm, context switch (ms), time slice (ms)
+//     uint32   number of processes, number of core speeds (0 if all cores run at base speed)
+//     uint64   number of bursts
+//     uint64   byte offset of the process table
+//     uint64   byte offset of the burst array
+//   core speeds: uint32 per core, in thousandths of the base speed
+//   burst array: uint32 per burst (ms), each process's bursts contiguous
+//   process table: one 24 byte record per process
+//     uint32   pid, start time (ms), number of bursts
+//     uint8    priority, 3 bytes padding
+//     uint64   index of the process's first burst in the burst array
+//
+// The loader maps the file and points ProcessDetails::burst_times straight
+// into the burst array, so nothing but the process table is decoded.
+
+static const char WORKLOAD_MAGIC[8] = { 'O', 'S', 'S', 'C', 'H', 'B', 'I', 'N' };
+static const uint32_t WORKLOAD_VERSION = 1;
+static const uint32_t WORKLOAD_HEADER_SIZE = 64;
+static const uint32_t WORKLOAD_RECORD_SIZE = 24;
+
+// Streaming writer: processes are appended one at a time and never held in
+// memory (the process table is spooled to a temporary file until close())
+class WorkloadWriter {
+private:
+    FILE *file;
+    FILE *table;
+    uint16_t cores;
+    ScheduleAlgorithm algorithm;
+    uint32_t context_switch;
+    uint32_t time_slice;
+    uint32_t num_processes;
+    uint32_t num_core_speeds;
+    uint64_t num_bursts;
+
+public:
+    WorkloadWriter();
+    ~WorkloadWriter();
+
+    bool open(const char *filename, uint16_t cores, ScheduleAlgorithm algorithm,
+              uint32_t context_switch, uint32_t time_slice, const uint16_t *core_speeds,
+              uint16_t num_core_speeds, std::string& error);
+    bool add(const ProcessDetails& details, std::string& error);
+    bool add(uint32_t pid, uint32_t start_time, uint8_t priority, const uint32_t *burst_times,
+             uint32_t count, std::string& error);
+    bool close(std::string& error);
+};
+
+bool writeBinaryConfig(const SchedulerConfig *config, const char *filename, std::string& error);
+SchedulerConfig* readBinaryConfig(const char *filename, std::string& error);
+bool isBinaryConfig(const char *filename);
+SchedulerConfig* loadWorkload(const char *filename, std::string& error);
+
+#endif // __WORKLOADFILE_H_
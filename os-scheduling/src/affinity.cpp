@@ -0,0 +1,128 @@
+#include "affinity.h"
+
+// AffinitySlots class methods
+AffinitySlots::AffinitySlots(uint32_t num_cores, uint32_t wait)
+{
+    uint32_t i;
+    this->num_cores = num_cores;
+    this->wait = wait;
+    slots = new Slot[num_cores];
+    for (i = 0; i < num_cores; i++)
+    {
+        slots[i].process = NULL;
+        slots[i].deadline = 0;
+    }
+    num_parked = 0;
+}
+
+AffinitySlots::~AffinitySlots()
+{
+    delete[] slots;
+}
+
+bool AffinitySlots::enabled() const
+{
+    return wait > 0;
+}
+
+bool AffinitySlots::park(Process *p, uint64_t now)
+{
+    int16_t core_id = p->getLastCore();
+    if (core_id < 0 || (uint32_t)core_id >= num_cores || slots[core_id].process != NULL)
+    {
+        return false;
+    }
+    slots[core_id].process = p;
+    slots[core_id].deadline.store(now + wait, std::memory_order_release);
+    num_parked++;
+    return true;
+}
+
+Process* AffinitySlots::claim(uint32_t core_id, uint64_t now)
+{
+    uint32_t i;
+    if (num_parked == 0)
+    {
+        return NULL;
+    }
+    int64_t best = -1;
+    uint64_t best_deadline = UINT64_MAX;
+    if (slots[core_id].process != NULL)
+    {
+        best = core_id;
+    }
+    for (i = 0; best != (int64_t)core_id && i < num_cores; i++)
+    {
+        uint64_t deadline = slots[i].deadline.load(std::memory_order_relaxed);
+        if (deadline != 0 && deadline <= now && deadline < best_deadline)
+        {
+            best = i;
+            best_deadline = deadline;
+        }
+    }
+    if (best < 0)
+    {
+        return NULL;
+    }
+    Process *p = slots[best].process;
+    slots[best].process = NULL;
+    slots[best].deadline.store(0, std::memory_order_release);
+    num_parked--;
+    return p;
+}
+
+// Lock-free check for idle cores: is there a process parked for this core,
+// or one whose wait has run out?
+bool AffinitySlots::claimable(uint32_t core_id, uint64_t now) const
+{
+    uint32_t i;
+    if (num_parked.load(std::memory_order_relaxed) == 0)
+    {
+        return false;
+    }
+    if (slots[core_id].deadline.load(std::memory_order_acquire) != 0)
+    {
+        return true;
+    }
+    for (i = 0; i < num_cores; i++)
+    {
+        uint64_t deadline = slots[i].deadline.load(std::memory_order_acquire);
+        if (deadline != 0 && deadline <= now)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t AffinitySlots::nextDeadline() const
+{
+    uint32_t i;
+    uint64_t next = UINT64_MAX;
+    for (i = 0; num_parked.load(std::memory_order_relaxed) > 0 && i < num_cores; i++)
+    {
+        uint64_t deadline = slots[i].deadline.load(std::memory_order_acquire);
+        if (deadline != 0 && deadline < next)
+        {
+            next = deadline;
+        }
+    }
+    return next;
+}
+
+uint32_t AffinitySlots::parked() const
+{
+    return num_parked.load(std::memory_order_relaxed);
+}
+
+void AffinitySlots::boost()
+{
+    uint32_t i;
+    for (i = 0; i < num_cores; i++)
+    {
+        if (slots[i].process != NULL)
+        {
+            slots[i].process->setLevel(0);
+        }
+    }
+}
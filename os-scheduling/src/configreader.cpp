@@ -1,21 +1,62 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "configreader.h"
 
+ScheduleAlgorithm scheduleAlgorithmFromString(const char *name, bool *ok)
+{
+    *ok = true;
+    if (strcmp(name, "FCFS") == 0) return ScheduleAlgorithm::FCFS;
+    if (strcmp(name, "SJF") == 0) return ScheduleAlgorithm::SJF;
+    if (strcmp(name, "RR") == 0) return ScheduleAlgorithm::RR;
+    if (strcmp(name, "PP") == 0) return ScheduleAlgorithm::PP;
+    if (strcmp(name, "MLFQ") == 0) return ScheduleAlgorithm::MLFQ;
+    if (strcmp(name, "CFS") == 0) return ScheduleAlgorithm::CFS;
+    *ok = false;
+    return ScheduleAlgorithm::FCFS;
+}
+
+const char* scheduleAlgorithmToString(ScheduleAlgorithm algorithm)
+{
+    static const char *names[] = { "FCFS", "SJF", "RR", "PP", "MLFQ", "CFS" };
+    return names[algorithm];
+}
+
 SchedulerConfig* readConfigFile(const char *filename)
 {
     std::string line;
     std::ifstream file(filename);
     SchedulerConfig *config = new SchedulerConfig();
     
-    // read line 1 --> number of cpu cores
+    // read line 1 --> number of cpu cores, optionally followed by each core's speed factor
     std::getline(file, line);
     config->cores = std::stoi(line);
+    std::stringstream speeds(line);
+    std::vector<uint16_t> core_speeds;
+    double speed;
+    speeds >> speed;
+    while (speeds >> speed && core_speeds.size() < config->cores)
+    {
+        core_speeds.push_back(speed * BASE_CORE_SPEED + 0.5);
+    }
+    if (!core_speeds.empty())
+    {
+        config->num_core_speeds = core_speeds.size();
+        config->core_speeds = new uint16_t[core_speeds.size()];
+        std::copy(core_speeds.begin(), core_speeds.end(), config->core_speeds);
+    }
 
     // read line 2 --> scheduling algorithm
     std::getline(file, line);
-    if      (line == "FCFS") config->algorithm = ScheduleAlgorithm::FCFS;
-    else if (line == "SJF")  config->algorithm = ScheduleAlgorithm::SJF;
-    else if (line == "RR")   config->algorithm = ScheduleAlgorithm::RR;
-    else if (line == "PP")   config->algorithm = ScheduleAlgorithm::PP;
+    bool known;     // not reported here: an unknown name leaves FCFS
+    config->algorithm = scheduleAlgorithmFromString(line.c_str(), &known);
 
     // read line 3 --> context switch time (ms)
     std::getline(file, line);
@@ -62,7 +103,7 @@ SchedulerConfig* readConfigFile(const char *filename)
 
         // column 4 --> priority
         std::getline(ss1, item1, ',');
-        if (config->algorithm == ScheduleAlgorithm::PP)
+        if (config->algorithm == ScheduleAlgorithm::PP || config->algorithm == ScheduleAlgorithm::CFS)
         {
             config->processes[i].priority = std::stoi(item1);
         }
@@ -78,11 +119,328 @@ SchedulerConfig* readConfigFile(const char *filename)
 void deleteConfig(SchedulerConfig *config)
 {
     int i;
-    for (i = 0; i < config->num_processes; i++)
+    if (config->mapping != NULL)
+    {
+        munmap(config->mapping, config->mapping_size);
+    }
+    if (config->burst_storage != NULL)
     {
-        delete[] config->processes[i].burst_times;
+        delete[] config->burst_storage;
+    }
+    else if (config->mapping == NULL)
+    {
+        for (i = 0; i < config->num_processes; i++)
+        {
+            delete[] config->processes[i].burst_times;
+        }
     }
     delete[] config->processes;
+    delete[] config->core_speeds;
+    delete[] config->io_devices;
     delete config;
     config = NULL;
 }
+
+// Speed of a core (cores past the end of the speed list run at the base speed)
+uint16_t coreSpeed(const SchedulerConfig *config, uint32_t core_id)
+{
+    return (core_id < config->num_core_speeds) ? config->core_speeds[core_id] : BASE_CORE_SPEED;
+}
+
+
+// Fast reader: the file is memory-mapped and parsed in place. A first pass
+// counts the '|' separators (16 bytes at a time with SSE2) so all burst times
+// fit one exactly-sized array; malformed input is reported with its line
+// number through `error` (and NULL is returned) instead of throwing.
+namespace {
+
+typedef struct Cursor {
+    const char *pos;    // next character to read
+    const char *end;    // end of the mapped file
+    uint32_t line;      // 1-based line number of `pos`
+} Cursor;
+
+size_t countByte(const char *p, const char *end, char c)
+{
+    size_t count = 0;
+#ifdef __SSE2__
+    const __m128i needle = _mm_set1_epi8(c);
+    for (; p + 16 <= end; p += 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+    }
+#endif
+    for (; p < end; p++)
+    {
+        count += (*p == c);
+    }
+    return count;
+}
+
+bool fail(const Cursor& cur, const char *what, std::string& error)
+{
+    error = "line " + std::to_string(cur.line) + ": " + what;
+    return false;
+}
+
+// Unsigned decimal integer no larger than `max`
+bool parseUint(Cursor& cur, uint64_t max, uint64_t *value, std::string& error)
+{
+    const char *p = cur.pos;
+    uint64_t v = 0;
+    while (p < cur.end && (*p == ' ' || *p == '\t'))
+    {
+        p++;
+    }
+    const char *digits = p;
+    while (p < cur.end && (unsigned)(*p - '0') < 10)
+    {
+        v = v * 10 + (*p - '0');
+        if (v > max)
+        {
+            return fail(cur, "number out of range", error);
+        }
+        p++;
+    }
+    if (p == digits)
+    {
+        return fail(cur, "expected a number", error);
+    }
+    while (p < cur.end && (*p == ' ' || *p == '\t'))
+    {
+        p++;
+    }
+    cur.pos = p;
+    *value = v;
+    return true;
+}
+
+bool expect(Cursor& cur, char c, const char *what, std::string& error)
+{
+    if (cur.pos >= cur.end || *cur.pos != c)
+    {
+        return fail(cur, what, error);
+    }
+    cur.pos++;
+    return true;
+}
+
+// Move past the end of the current line (which must not hold anything else)
+bool endLine(Cursor& cur, std::string& error)
+{
+    if (cur.pos < cur.end && *cur.pos == '\r')
+    {
+        cur.pos++;
+    }
+    if (cur.pos < cur.end && *cur.pos != '\n')
+    {
+        return fail(cur, "unexpected characters at end of line", error);
+    }
+    if (cur.pos < cur.end)
+    {
+        cur.pos++;
+    }
+    cur.line++;
+    return true;
+}
+
+// Decimal speed factor in thousandths, rounded to the nearest as the slow
+// reader does (the whole part may be left out, as in ".5")
+bool parseSpeed(Cursor& cur, uint16_t *speed, std::string& error)
+{
+    uint64_t whole = 0;
+    uint64_t fraction = 0;
+    uint64_t scale = BASE_CORE_SPEED;
+    while (cur.pos < cur.end && (*cur.pos == ' ' || *cur.pos == '\t'))
+    {
+        cur.pos++;
+    }
+    bool no_whole = (cur.pos < cur.end && *cur.pos == '.');
+    if (!no_whole && !parseUint(cur, UINT16_MAX / BASE_CORE_SPEED, &whole, error)) return false;
+    if (cur.pos < cur.end && *cur.pos == '.')
+    {
+        const char *digits = ++cur.pos;
+        while (cur.pos < cur.end && (unsigned)(*cur.pos - '0') < 10)
+        {
+            if (scale > 1)
+            {
+                scale /= 10;
+                fraction += (*cur.pos - '0') * scale;
+            }
+            else if (cur.pos - digits == 3 && *cur.pos >= '5')
+            {
+                fraction++;
+            }
+            cur.pos++;
+        }
+        if (no_whole && cur.pos == digits)
+        {
+            return fail(cur, "expected a number", error);
+        }
+        while (cur.pos < cur.end && (*cur.pos == ' ' || *cur.pos == '\t'))
+        {
+            cur.pos++;
+        }
+    }
+    if (whole * BASE_CORE_SPEED + fraction == 0 || whole * BASE_CORE_SPEED + fraction > UINT16_MAX)
+    {
+        return fail(cur, "core speed out of range", error);
+    }
+    *speed = whole * BASE_CORE_SPEED + fraction;
+    return true;
+}
+
+bool headerValue(Cursor& cur, uint64_t max, uint64_t *value, std::string& error)
+{
+    return parseUint(cur, max, value, error) && endLine(cur, error);
+}
+
+bool parseConfig(Cursor& cur, SchedulerConfig *config, std::string& error)
+{
+    uint64_t value;
+    int i;
+
+    // line 1 --> number of cpu cores, optionally followed by each core's speed factor
+    if (!parseUint(cur, MAX_CORES, &value, error)) return false;
+    if (value == 0) return fail(cur, "need at least one core", error);
+    config->cores = value;
+    if (cur.pos < cur.end && *cur.pos != '\n' && *cur.pos != '\r')
+    {
+        // cores without a speed run at speed 1 (see coreSpeed())
+        config->core_speeds = new uint16_t[config->cores];
+        for (i = 0; cur.pos < cur.end && *cur.pos != '\n' && *cur.pos != '\r'; i++)
+        {
+            if (i == config->cores) return fail(cur, "more core speeds than cores", error);
+            if (!parseSpeed(cur, &config->core_speeds[i], error)) return false;
+        }
+        config->num_core_speeds = i;
+    }
+    if (!endLine(cur, error)) return false;
+
+    // line 2 --> scheduling algorithm
+    const char *name = cur.pos;
+    const char *eol = (const char *)memchr(name, '\n', cur.end - name);
+    const char *name_end = (eol != NULL) ? eol : cur.end;
+    while (name_end > name && (name_end[-1] == '\r' || name_end[-1] == ' ' || name_end[-1] == '\t'))
+    {
+        name_end--;
+    }
+    std::string algorithm(name, name_end - name);
+    bool known;
+    config->algorithm = scheduleAlgorithmFromString(algorithm.c_str(), &known);
+    if (!known) return fail(cur, ("unknown scheduling algorithm '" + algorithm + "'").c_str(), error);
+    cur.pos = (eol != NULL) ? eol + 1 : cur.end;
+    cur.line++;
+
+    // line 3 --> context switch time (ms), line 4 --> time slice (ms)
+    if (!headerValue(cur, UINT32_MAX, &value, error)) return false;
+    config->context_switch = value;
+    if (!headerValue(cur, UINT32_MAX, &value, error)) return false;
+    config->time_slice = value;
+
+    // line 5 --> number of processes
+    if (!headerValue(cur, MAX_PROCESSES, &value, error)) return false;
+    config->num_processes = value;
+    // every process line takes at least 8 bytes ("0,0,0,0" and a newline,
+    // which the last one may leave out), so check before allocating for them
+    uint64_t room = (cur.end - cur.pos + 1) / 8;
+    if (config->num_processes > room)
+    {
+        return fail(cur, ("expected " + std::to_string(config->num_processes) + " processes, the rest of the file " +
+                          "has room for at most " + std::to_string(room)).c_str(), error);
+    }
+
+    // all bursts in one array: every process line has one more burst than '|'
+    size_t num_bursts = countByte(cur.pos, cur.end, '|') + config->num_processes;
+    config->processes = new ProcessDetails[config->num_processes];
+    config->burst_storage = new uint32_t[num_bursts];
+    uint32_t *bursts = config->burst_storage;
+    uint32_t *bursts_end = bursts + num_bursts;
+
+    // lines 6 - N --> pid,start time,burst|burst|...,priority
+    for (i = 0; i < config->num_processes; i++)
+    {
+        ProcessDetails& details = config->processes[i];
+        if (cur.pos >= cur.end)
+        {
+            return fail(cur, ("expected " + std::to_string(config->num_processes) + " processes, found " +
+                              std::to_string(i)).c_str(), error);
+        }
+        if (!parseUint(cur, UINT32_MAX, &value, error)) return false;
+        details.pid = value;
+        if (!expect(cur, ',', "expected ',' after pid", error)) return false;
+        if (!parseUint(cur, UINT32_MAX, &value, error)) return false;
+        details.start_time = value;
+        if (!expect(cur, ',', "expected ',' after start time", error)) return false;
+
+        details.burst_times = bursts;
+        details.num_bursts = 0;
+        while (true)
+        {
+            if (bursts == bursts_end || details.num_bursts == UINT16_MAX)
+            {
+                return fail(cur, "too many bursts", error);
+            }
+            if (!parseUint(cur, UINT32_MAX, &value, error)) return false;
+            *bursts++ = value;
+            details.num_bursts++;
+            if (cur.pos == cur.end || *cur.pos != '|')
+            {
+                break;
+            }
+            cur.pos++;
+        }
+
+        if (!expect(cur, ',', "expected ',' after burst times", error)) return false;
+        if (!parseUint(cur, UINT8_MAX, &value, error)) return false;
+        details.priority = value;  // kept even when not PP, ProcessTable decides
+        if (!endLine(cur, error)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+SchedulerConfig* readConfigFileFast(const char *filename, std::string& error)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        error = std::string("cannot open file: ") + strerror(errno);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        error = "file is empty or unreadable";
+        close(fd);
+        return NULL;
+    }
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        error = std::string("cannot map file: ") + strerror(errno);
+        return NULL;
+    }
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    Cursor cur;
+    cur.pos = (const char *)data;
+    cur.end = cur.pos + st.st_size;
+    cur.line = 1;
+    SchedulerConfig *config = new SchedulerConfig();
+    bool ok = parseConfig(cur, config, error);
+    munmap(data, st.st_size);
+
+    if (!ok)
+    {
+        delete[] config->processes;
+        delete[] config->burst_storage;
+        delete[] config->core_speeds;
+        delete config;
+        return NULL;
+    }
+    return config;
+}
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include "coremodel.h"
+
+uint64_t runTimeOnCore(uint64_t work, uint16_t speed)
+{
+    return (work * BASE_CORE_SPEED + speed - 1) / speed;
+}
+
+uint32_t workLeftOnCore(uint32_t work, uint64_t elapsed, uint16_t speed)
+{
+    uint64_t done = elapsed * speed / BASE_CORE_SPEED;
+    return (done < work) ? work - done : 0;
+}
+
+// One idle entry per core of the config
+std::vector<CoreUsage> coreUsage(const SchedulerConfig *config)
+{
+    uint32_t i;
+    std::vector<CoreUsage> usage(config->cores);
+    for (i = 0; i < usage.size(); i++)
+    {
+        usage[i].speed = coreSpeed(config, i);
+        usage[i].busy = 0;
+        usage[i].last_busy = 0;
+    }
+    return usage;
+}
+
+// A process that started running at `burst_start` came off the core
+void recordCoreBusy(CoreUsage& usage, uint64_t burst_start, uint64_t now)
+{
+    usage.busy += now - burst_start;
+    usage.last_busy = now;
+}
+
+// Cores are grouped by speed, fastest first. A class's makespan is when its
+// last process came off one of its cores (`start` is time 0 of the run):
+// well-placed work keeps the slow cores from finishing long after the rest.
+void printCoreUsage(FILE *out, const std::vector<CoreUsage>& cores, uint64_t start, uint64_t makespan)
+{
+    size_t i;
+    std::vector<uint16_t> speeds;
+    for (i = 0; i < cores.size(); i++)
+    {
+        speeds.push_back(cores[i].speed);
+    }
+    std::sort(speeds.begin(), speeds.end());
+    speeds.erase(std::unique(speeds.begin(), speeds.end()), speeds.end());
+    if (speeds.empty() || (speeds.size() == 1 && speeds[0] == BASE_CORE_SPEED))
+    {
+        return;
+    }
+
+    std::vector<uint16_t>::reverse_iterator speed;
+    for (speed = speeds.rbegin(); speed != speeds.rend(); ++speed)
+    {
+        uint32_t count = 0;
+        uint64_t busy = 0;
+        uint64_t last = start;
+        for (i = 0; i < cores.size(); i++)
+        {
+            if (cores[i].speed == *speed)
+            {
+                count++;
+                busy += cores[i].busy;
+                last = std::max(last, cores[i].last_busy);
+            }
+        }
+        double available = (double)count * makespan;
+        fprintf(out, "Cores at speed %.3f: %u, %.1f%% utilized, makespan %.3f s\n", *speed / (double)BASE_CORE_SPEED,
+                count, (available > 0.0) ? 100.0 * busy / available : 0.0, (last - start) / 1000.0);
+    }
+}
@@ -0,0 +1,360 @@
+#include <algorithm>
+#include <chrono>
+#include <string>
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include "corepool.h"
+#include "trace.h"
+
+namespace {
+
+// Same clock (ms since the epoch) as the monitor's currentTime()
+uint64_t clockMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+           std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+// ThreadExecutor class methods
+ThreadExecutor::ThreadExecutor(uint32_t num_cores)
+{
+    uint32_t i;
+    this->num_cores = num_cores;
+    cores = new Core[num_cores];
+    for (i = 0; i < num_cores; i++)
+    {
+        cores[i].woken = false;
+    }
+}
+
+ThreadExecutor::~ThreadExecutor()
+{
+    delete[] cores;
+}
+
+uint32_t ThreadExecutor::workers() const
+{
+    return num_cores;
+}
+
+void ThreadExecutor::start(const std::vector<CoreTask*>& tasks)
+{
+    size_t i;
+    for (i = 0; i < tasks.size(); i++)
+    {
+        threads.push_back(std::thread(&ThreadExecutor::run, this, tasks[i], i));
+    }
+}
+
+// Step, then sleep until the step's resume time or a wake
+void ThreadExecutor::run(CoreTask *task, uint16_t core_id)
+{
+    TRACE_THREAD(("core " + std::to_string(core_id)).c_str(), core_id);
+    Core& core = cores[core_id];
+    while (true)
+    {
+        uint64_t next = task->step(clockMs(), core_id);
+        if (next == CoreTask::FINISHED)
+        {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(core.mutex);
+        while (!core.woken)
+        {
+            if (next == CoreTask::WAIT)
+            {
+                core.wakeup.wait(lock);
+                continue;
+            }
+            uint64_t now = clockMs();
+            if (now >= next)
+            {
+                break;
+            }
+            core.wakeup.wait_for(lock, std::chrono::milliseconds(next - now));
+        }
+        core.woken = false;
+    }
+}
+
+void ThreadExecutor::wake(uint16_t core_id)
+{
+    std::lock_guard<std::mutex> lock(cores[core_id].mutex);
+    cores[core_id].woken = true;
+    cores[core_id].wakeup.notify_one();
+}
+
+void ThreadExecutor::join()
+{
+    size_t i;
+    for (i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+    threads.clear();
+}
+
+// PoolExecutor class methods
+PoolExecutor::PoolExecutor(uint32_t num_workers)
+{
+    uint32_t i;
+    this->num_workers = std::max<uint32_t>(num_workers, 1);
+    pool = new Worker[this->num_workers];
+    for (i = 0; i < this->num_workers; i++)
+    {
+        pool[i].stepping = false;
+        pool[i].sleeping = false;
+        pool[i].poked = false;
+        pool[i].steps = 0;
+        pool[i].steals = 0;
+    }
+    cores = NULL;
+    finished = 0;
+}
+
+PoolExecutor::~PoolExecutor()
+{
+    delete[] pool;
+    delete[] cores;
+}
+
+uint32_t PoolExecutor::workers() const
+{
+    return num_workers;
+}
+
+// Every core is due at once, spread round-robin over the workers
+void PoolExecutor::start(const std::vector<CoreTask*>& tasks)
+{
+    uint32_t i;
+    this->tasks = tasks;
+    cores = new Core[tasks.size()];
+    for (i = 0; i < tasks.size(); i++)
+    {
+        Core& core = cores[i];
+        core.seq = 0;
+        core.home = i % num_workers;
+        core.running = false;
+        core.woken = false;
+        core.finished = false;
+        Entry entry = { 0, 0, (uint16_t)i };
+        push(core.home, entry);
+    }
+    for (i = 0; i < num_workers; i++)
+    {
+        threads.push_back(std::thread(&PoolExecutor::run, this, i));
+    }
+}
+
+void PoolExecutor::push(uint32_t worker, const Entry& entry)
+{
+    Worker& w = pool[worker];
+    bool stuck;
+    {
+        std::lock_guard<std::mutex> lock(w.mutex);
+        w.heap.push_back(entry);
+        std::push_heap(w.heap.begin(), w.heap.end(), EntryLater());
+        if (w.heap.front().seq == entry.seq && w.heap.front().core == entry.core)
+        {
+            // new earliest entry: the worker may be sleeping past it
+            w.wakeup.notify_one();
+        }
+        stuck = w.stepping && entry.time <= clockMs();
+    }
+    if (stuck)
+    {
+        pokeIdle(worker);
+    }
+}
+
+// A worker starts or finishes a step. Starting one with due entries left in
+// its heap pokes a sleeping worker to steal them.
+void PoolExecutor::setStepping(uint32_t worker, bool stepping)
+{
+    Worker& w = pool[worker];
+    bool stuck;
+    {
+        std::lock_guard<std::mutex> lock(w.mutex);
+        w.stepping = stepping;
+        stuck = stepping && !w.heap.empty() && w.heap.front().time <= clockMs();
+    }
+    if (stuck)
+    {
+        pokeIdle(worker);
+    }
+}
+
+// Wake one sleeping worker other than `worker` to look for work to steal
+void PoolExecutor::pokeIdle(uint32_t worker)
+{
+    uint32_t i;
+    for (i = 1; i < num_workers; i++)
+    {
+        Worker& idle = pool[(worker + i) % num_workers];
+        std::lock_guard<std::mutex> lock(idle.mutex);
+        if (idle.sleeping)
+        {
+            idle.poked = true;
+            idle.wakeup.notify_one();
+            return;
+        }
+    }
+}
+
+bool PoolExecutor::popDue(uint32_t worker, uint64_t now, Entry *entry)
+{
+    Worker& w = pool[worker];
+    std::lock_guard<std::mutex> lock(w.mutex);
+    if (w.heap.empty() || w.heap.front().time > now)
+    {
+        return false;
+    }
+    std::pop_heap(w.heap.begin(), w.heap.end(), EntryLater());
+    *entry = w.heap.back();
+    w.heap.pop_back();
+    return true;
+}
+
+// Take a due entry from the first other worker that has one (without
+// waiting for a busy worker's lock)
+bool PoolExecutor::steal(uint32_t worker, uint64_t now, Entry *entry)
+{
+    uint32_t i;
+    for (i = 1; i < num_workers; i++)
+    {
+        Worker& victim = pool[(worker + i) % num_workers];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (lock.owns_lock() && !victim.heap.empty() && victim.heap.front().time <= now)
+        {
+            std::pop_heap(victim.heap.begin(), victim.heap.end(), EntryLater());
+            *entry = victim.heap.back();
+            victim.heap.pop_back();
+            pool[worker].steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void PoolExecutor::runEntry(uint32_t worker, const Entry& entry)
+{
+    Core& core = cores[entry.core];
+    {
+        std::lock_guard<std::mutex> lock(core.mutex);
+        if (entry.seq != core.seq || core.running || core.finished)
+        {
+            return;
+        }
+        core.running = true;
+        core.woken = false;
+        core.home = worker;
+    }
+    setStepping(worker, true);
+    uint64_t next = tasks[entry.core]->step(clockMs(), worker);
+    setStepping(worker, false);
+    pool[worker].steps++;
+
+    std::lock_guard<std::mutex> lock(core.mutex);
+    core.running = false;
+    if (next == CoreTask::FINISHED)
+    {
+        core.finished = true;
+        if (++finished == tasks.size())
+        {
+            uint32_t i;
+            for (i = 0; i < num_workers; i++)
+            {
+                std::lock_guard<std::mutex> worker_lock(pool[i].mutex);
+                pool[i].wakeup.notify_one();
+            }
+        }
+        return;
+    }
+    if (core.woken)
+    {
+        next = 0;
+        core.woken = false;
+    }
+    if (next != CoreTask::WAIT)
+    {
+        core.seq++;
+        Entry resume = { next, core.seq, entry.core };
+        push(worker, resume);
+    }
+}
+
+void PoolExecutor::run(uint32_t worker)
+{
+    Worker& w = pool[worker];
+    while (finished < tasks.size())
+    {
+        uint64_t now = clockMs();
+        Entry entry;
+        if (popDue(worker, now, &entry) || steal(worker, now, &entry))
+        {
+            runEntry(worker, entry);
+            continue;
+        }
+        // nothing due: sleep until the earliest entry, a push, a poke or the end
+        std::unique_lock<std::mutex> lock(w.mutex);
+        if (finished < tasks.size() && !w.poked && (w.heap.empty() || w.heap.front().time > now))
+        {
+            w.sleeping = true;
+            if (w.heap.empty())
+            {
+                w.wakeup.wait(lock);
+            }
+            else
+            {
+                w.wakeup.wait_for(lock, std::chrono::milliseconds(w.heap.front().time - now));
+            }
+            w.sleeping = false;
+        }
+        w.poked = false;
+    }
+}
+
+// Resume the core now: a pending entry is superseded by one due at once
+void PoolExecutor::wake(uint16_t core_id)
+{
+    Core& core = cores[core_id];
+    std::lock_guard<std::mutex> lock(core.mutex);
+    if (core.finished)
+    {
+        return;
+    }
+    if (core.running)
+    {
+        core.woken = true;
+        return;
+    }
+    core.seq++;
+    Entry entry = { 0, core.seq, core_id };
+    push(core.home, entry);
+}
+
+void PoolExecutor::join()
+{
+    size_t i;
+    for (i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+    threads.clear();
+}
+
+void PoolExecutor::printStats(FILE *out) const
+{
+    uint32_t i;
+    uint64_t steps = 0;
+    uint64_t steals = 0;
+    for (i = 0; i < num_workers; i++)
+    {
+        steps += pool[i].steps;
+        steals += pool[i].steals;
+    }
+    fprintf(out, "Core pool: %zu cores on %u threads, %" PRIu64 " steps, %" PRIu64 " stolen (%.1f%%)\n",
+            tasks.size(), num_workers, steps, steals, (steps > 0) ? 100.0 * steals / steps : 0.0);
+}
@@ -0,0 +1,160 @@
+#include <cmath>
+#include <cstring>
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include "histogram.h"
+
+// LatencyHistogram class methods
+LatencyHistogram::LatencyHistogram()
+{
+    memset(counts, 0, sizeof(counts));
+    total = 0;
+    sum = 0;
+    min_value = UINT64_MAX;
+    max_value = 0;
+}
+
+// Bucket g (g >= 1) of SUB_BUCKETS covers values whose top bit is bit
+// g + SUB_BITS - 1, split on the SUB_BITS bits below it
+int LatencyHistogram::bucketOf(uint64_t value)
+{
+    if (value < (uint64_t)SUB_BUCKETS)
+    {
+        return value;
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int group = msb - SUB_BITS + 1;
+    int sub = (value >> (group - 1)) - SUB_BUCKETS;
+    return group * SUB_BUCKETS + sub;
+}
+
+// Largest value that falls in `bucket`
+uint64_t LatencyHistogram::bucketHighest(int bucket)
+{
+    if (bucket < SUB_BUCKETS)
+    {
+        return bucket;
+    }
+    int group = bucket / SUB_BUCKETS;
+    uint64_t lowest = (uint64_t)(SUB_BUCKETS + bucket % SUB_BUCKETS) << (group - 1);
+    return lowest + (((uint64_t)1 << (group - 1)) - 1);
+}
+
+void LatencyHistogram::record(uint64_t value)
+{
+    counts[bucketOf(value)]++;
+    total++;
+    sum += value;
+    min_value = (value < min_value) ? value : min_value;
+    max_value = (value > max_value) ? value : max_value;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    int i;
+    for (i = 0; i < BUCKETS; i++)
+    {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    sum += other.sum;
+    min_value = (other.min_value < min_value) ? other.min_value : min_value;
+    max_value = (other.max_value > max_value) ? other.max_value : max_value;
+}
+
+uint64_t LatencyHistogram::count() const
+{
+    return total;
+}
+
+uint64_t LatencyHistogram::min() const
+{
+    return (total > 0) ? min_value : 0;
+}
+
+uint64_t LatencyHistogram::max() const
+{
+    return max_value;
+}
+
+double LatencyHistogram::mean() const
+{
+    return (total > 0) ? (double)sum / total : 0.0;
+}
+
+// Smallest bucket value that at least `percent`% of the recorded values are
+// at or below (clamped to the exact min/max)
+uint64_t LatencyHistogram::percentile(double percent) const
+{
+    int i;
+    if (total == 0)
+    {
+        return 0;
+    }
+    uint64_t target = (uint64_t)ceil(percent / 100.0 * total);
+    target = (target < 1) ? 1 : target;
+    uint64_t seen = 0;
+    for (i = 0; i < BUCKETS; i++)
+    {
+        seen += counts[i];
+        if (seen >= target)
+        {
+            uint64_t value = bucketHighest(i);
+            value = (value > max_value) ? max_value : value;
+            return (value < min_value) ? min_value : value;
+        }
+    }
+    return max_value;
+}
+
+
+// SchedulingLatencies methods
+namespace {
+
+uint64_t millis(double seconds)
+{
+    return (seconds > 0.0) ? (uint64_t)llround(seconds * 1000.0) : 0;
+}
+
+void printRow(FILE *out, const char *name, const LatencyHistogram& h)
+{
+    fprintf(out, "  %-10s %9" PRIu64 " %10.1f %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 "\n",
+            name, h.count(), h.mean(), h.percentile(50.0), h.percentile(90.0), h.percentile(99.0),
+            h.percentile(99.9), h.max());
+}
+
+} // namespace
+
+void SchedulingLatencies::dispatched(const Process *p, uint64_t current_time)
+{
+    uint64_t ready_since = p->getStateStart();
+    dispatch.record((current_time > ready_since) ? current_time - ready_since : 0);
+    if (!p->hasRun())
+    {
+        uint64_t launched = p->getLaunchTime();
+        response.record((current_time > launched) ? current_time - launched : 0);
+    }
+}
+
+void SchedulingLatencies::terminated(const Process *p)
+{
+    turnaround.record(millis(p->getTurnaroundTime()));
+    wait.record(millis(p->getWaitTime()));
+}
+
+void SchedulingLatencies::merge(const SchedulingLatencies& other)
+{
+    turnaround.merge(other.turnaround);
+    wait.merge(other.wait);
+    response.merge(other.response);
+    dispatch.merge(other.dispatch);
+}
+
+void SchedulingLatencies::print(FILE *out) const
+{
+    fprintf(out, "Latency (ms)     count       mean       p50       p90       p99     p99.9       max\n");
+    printRow(out, "turnaround", turnaround);
+    printRow(out, "wait", wait);
+    printRow(out, "response", response);
+    printRow(out, "dispatch", dispatch);
+}
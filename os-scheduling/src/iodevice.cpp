@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include "iodevice.h"
+
+// IoDevice class methods
+IoDevice::IoDevice(const IoDeviceSpec& spec) : spec(spec)
+{
+    order.policy = spec.policy;
+    in_service = 0;
+    next_seq = 0;
+    requests = 0;
+    service_ms = 0;
+    longest_queue = 0;
+}
+
+bool IoDevice::submit(Process *p, uint64_t now)
+{
+    requests++;
+    if (in_service < spec.capacity)
+    {
+        in_service++;
+        service_ms += p->getCurrentBurstTime();
+        queueing.record(0);
+        return true;
+    }
+    Request request;
+    request.process = p;
+    request.length = p->getCurrentBurstTime();
+    request.submitted = now;
+    request.seq = next_seq++;
+    waiting.push_back(request);
+    std::push_heap(waiting.begin(), waiting.end(), order);
+    longest_queue = std::max(longest_queue, waiting.size());
+    return false;
+}
+
+Process* IoDevice::finish(uint64_t now)
+{
+    if (waiting.empty())
+    {
+        in_service--;
+        return NULL;
+    }
+    std::pop_heap(waiting.begin(), waiting.end(), order);
+    Request next = waiting.back();
+    waiting.pop_back();
+    service_ms += next.length;
+    queueing.record((now > next.submitted) ? now - next.submitted : 0);
+    return next.process;
+}
+
+// Utilization is the share of the device's slots (capacity x makespan) spent serving
+void IoDevice::print(FILE *out, uint32_t id, uint64_t makespan) const
+{
+    double available = (double)spec.capacity * makespan;
+    fprintf(out, "I/O device %u (%u x %s): %" PRIu64 " requests, %.1f%% utilized, queueing (ms) mean %.1f "
+            "p50 %" PRIu64 " p99 %" PRIu64 " max %" PRIu64 ", longest queue %zu\n", id, spec.capacity,
+            (spec.policy == IoDeviceSpec::ShortestFirst) ? "shortest" : "fifo", requests,
+            (available > 0.0) ? 100.0 * service_ms / available : 0.0, queueing.mean(),
+            queueing.percentile(50.0), queueing.percentile(99.0), queueing.max(),
+            longest_queue);
+}
+
+// IoDevices class methods
+IoDevices::IoDevices(const SchedulerConfig *config)
+{
+    uint32_t i;
+    for (i = 0; i < config->num_io_devices; i++)
+    {
+        devices.push_back(IoDevice(config->io_devices[i]));
+    }
+}
+
+bool IoDevices::enabled() const
+{
+    return !devices.empty();
+}
+
+IoDevice& IoDevices::deviceOf(const Process *p)
+{
+    return devices[p->getPid() % devices.size()];
+}
+
+void IoDevices::print(FILE *out, uint64_t makespan) const
+{
+    size_t i;
+    for (i = 0; i < devices.size(); i++)
+    {
+        devices[i].print(out, i, makespan);
+    }
+}
+
+// "CAPACITY[:fifo|shortest],..." with one entry per device, e.g. "2,1:shortest"
+bool parseIoDevices(const char *text, std::vector<IoDeviceSpec>& devices)
+{
+    char *end;
+    devices.clear();
+    while (*text != '\0')
+    {
+        IoDeviceSpec device;
+        unsigned long capacity = strtoul(text, &end, 10);
+        if (end == text || capacity == 0 || capacity > UINT32_MAX)
+        {
+            return false;
+        }
+        device.capacity = capacity;
+        device.policy = IoDeviceSpec::Fifo;
+        if (*end == ':')
+        {
+            const char *name = end + 1;
+            size_t length = strcspn(name, ",");
+            if (length == 4 && strncmp(name, "fifo", 4) == 0)
+            {
+                device.policy = IoDeviceSpec::Fifo;
+            }
+            else if (length == 8 && strncmp(name, "shortest", 8) == 0)
+            {
+                device.policy = IoDeviceSpec::ShortestFirst;
+            }
+            else
+            {
+                return false;
+            }
+            end = (char*)name + length;
+        }
+        if (*end != ',' && *end != '\0')
+        {
+            return false;
+        }
+        devices.push_back(device);
+        text = (*end == ',') ? end + 1 : end;
+    }
+    return !devices.empty() && devices.size() <= UINT8_MAX;
+}
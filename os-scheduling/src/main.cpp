@@ -6,9 +6,26 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <cstring>
+#include <ctime>
 #include <unistd.h>
 #include "configreader.h"
+#include "coremodel.h"
+#include "corepool.h"
+#include "histogram.h"
+#include "iodevice.h"
+#include "policy.h"
 #include "process.h"
+#include "processtable.h"
+#include "profile.h"
+#include "runqueues.h"
+#include "simulator.h"
+#include "statusdisplay.h"
+#include "sweep.h"
+#include "timerwheel.h"
+#include "trace.h"
+#include "workloadfile.h"
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
 #include <algorithm>
@@ -16,21 +33,46 @@
 //
 // Shared data for all cores
 typedef struct SchedulerData {
-    std::mutex mutex;
-    std::condition_variable condition;//may need to use this for process if it is interrupted or not - Kong - 03/31/2021
+    CoreExecutor *executor;             // steps the cores; wake() resumes one early (interrupt, new work)
     ScheduleAlgorithm algorithm;
     uint32_t context_switch;
-    uint32_t time_slice;
-    std::list<Process*> ready_queue;
-    bool all_terminated;
-    
+    uint32_t migration_penalty;         // extra switch time (ms) when a process changes cores
+    RunQueues *run_queues;              // ready queue(s) and the locks guarding them
+    std::atomic<Process*> *running;     // one per core: process on the core (NULL if none)
+    ProfiledMutex io_mutex;
+    std::vector<Process*> io_started;   // processes that began an I/O burst since the last tick
+    std::atomic<uint32_t> num_terminated;
+    std::atomic<bool> all_terminated;
+    SchedulingLatencies *latencies;     // one per executor thread: only that thread records into it
+    CoreUsage *usage;                   // one per core (with its speed): only that core's steps update it
+
 } SchedulerData;
 
-void coreRunProcesses(uint8_t core_id, SchedulerData *data);
-int printProcessOutput(std::vector<Process*>& processes, std::mutex& mutex);
-void clearOutput(int num_lines);
+template <typename Policy>
+void runRealTime(SchedulerConfig *config, ProcessTable& processes, uint64_t start, SchedulerData *shared_data,
+                 IoDevices *io_devices, StatusDisplay *display);
+template <typename Policy>
+class SimulatedCore;
+void printProcessOutput(ProcessTable& processes, uint64_t current_time);
+void printSwitchCosts(ProcessTable& processes, uint64_t switches, uint32_t context_switch,
+                      uint32_t migration_penalty, uint16_t cores, uint64_t makespan);
 uint64_t currentTime();
-std::string processStateToString(Process::State state);
+
+// Starts the real-time run specialized for the workload's policy
+typedef struct RealTimeRun {
+    SchedulerConfig *config;
+    ProcessTable *processes;
+    uint64_t start;
+    SchedulerData *shared_data;
+    IoDevices *io_devices;
+    StatusDisplay *display;
+
+    template <typename Policy>
+    void run()
+    {
+        runRealTime<Policy>(config, *processes, start, shared_data, io_devices, display);
+    }
+} RealTimeRun;
 
 
 int main(int argc, char **argv)
@@ -42,214 +84,315 @@ int main(int argc, char **argv)
         exit(EXIT_FAILURE);
     }
 
+    // Optional flags: --virtual runs the simulation on a virtual clock,
+    // --queues=global|percore picks the run queue layout for the core threads,
+    // --sweep (with the lists after it) runs a parameter sweep instead,
+    // --trace=FILE writes a Chrome trace of the real-time run (make TRACE=1),
+    // --headless skips the process tables, --refresh=MS caps the live table's frame rate,
+    // --migration-penalty=MS adds to the switch when a process changes cores and
+    // --affinity=MS lets a ready process wait that long for the core it last ran on and
+    // --placement=speed puts the longest bursts on the fastest free cores (default naive) and
+    // --io-devices=CAPACITY[:fifo|shortest],... makes I/O bursts queue for those devices and
+    // --pool=THREADS runs the cores on that many host threads (0: one per hardware thread) and
+    // --profile reports lock waits and hold times per call site and each core's time (make PROFILE=1)
+    bool virtual_time = false;
+    bool headless = false;
+    uint32_t refresh_interval = 100;
+    const char *trace_file = NULL;
+    RunQueues::Mode queue_mode = RunQueues::Mode::Global;
+    uint32_t migration_penalty = 0;
+    uint32_t affinity_wait = 0;
+    bool speed_placement = false;
+    std::vector<IoDeviceSpec> io_devices;
+    int32_t pool_threads = -1;
+    bool profile = false;
+    bool sweep = false;
+    bool sweep_json = false;
+    SweepParameters sweep_params;
+    sweep_params.jobs = 0;
+    for (int a = 2; a < argc; a++)
+    {
+        bool ok = true;
+        if (strcmp(argv[a], "--virtual") == 0)
+        {
+            virtual_time = true;
+        }
+        else if (strncmp(argv[a], "--queues=", 9) == 0)
+        {
+            queue_mode = runQueueModeFromString(argv[a] + 9, &ok);
+        }
+        else if (strncmp(argv[a], "--trace=", 8) == 0)
+        {
+            trace_file = argv[a] + 8;
+        }
+        else if (strcmp(argv[a], "--profile") == 0)
+        {
+            profile = true;
+        }
+        else if (strcmp(argv[a], "--headless") == 0)
+        {
+            headless = true;
+        }
+        else if (strncmp(argv[a], "--refresh=", 10) == 0)
+        {
+            refresh_interval = atoi(argv[a] + 10);
+        }
+        else if (strncmp(argv[a], "--migration-penalty=", 20) == 0)
+        {
+            migration_penalty = atoi(argv[a] + 20);
+        }
+        else if (strncmp(argv[a], "--affinity=", 11) == 0)
+        {
+            affinity_wait = atoi(argv[a] + 11);
+        }
+        else if (strncmp(argv[a], "--placement=", 12) == 0)
+        {
+            speed_placement = (strcmp(argv[a] + 12, "speed") == 0);
+            ok = speed_placement || strcmp(argv[a] + 12, "naive") == 0;
+        }
+        else if (strncmp(argv[a], "--io-devices=", 13) == 0)
+        {
+            ok = parseIoDevices(argv[a] + 13, io_devices);
+        }
+        else if (strncmp(argv[a], "--pool=", 7) == 0)
+        {
+            pool_threads = atoi(argv[a] + 7);
+            ok = pool_threads >= 0;
+        }
+        else if (strcmp(argv[a], "--sweep") == 0)
+        {
+            sweep = true;
+        }
+        else if (strncmp(argv[a], "--algorithms=", 13) == 0)
+        {
+            ok = parseSweepAlgorithms(argv[a] + 13, sweep_params.algorithms);
+        }
+        else if (strncmp(argv[a], "--cores=", 8) == 0)
+        {
+            ok = parseSweepValues(argv[a] + 8, sweep_params.cores);
+            for (size_t c = 0; c < sweep_params.cores.size(); c++)
+            {
+                ok = ok && sweep_params.cores[c] >= 1 && sweep_params.cores[c] <= MAX_CORES;
+            }
+        }
+        else if (strncmp(argv[a], "--time-slices=", 14) == 0)
+        {
+            ok = parseSweepValues(argv[a] + 14, sweep_params.time_slices);
+        }
+        else if (strncmp(argv[a], "--context-switches=", 19) == 0)
+        {
+            ok = parseSweepValues(argv[a] + 19, sweep_params.context_switches);
+        }
+        else if (strncmp(argv[a], "--jobs=", 7) == 0)
+        {
+            sweep_params.jobs = atoi(argv[a] + 7);
+        }
+        else if (strncmp(argv[a], "--format=", 9) == 0)
+        {
+            sweep_json = (strcmp(argv[a] + 9, "json") == 0);
+            ok = sweep_json || strcmp(argv[a] + 9, "csv") == 0;
+        }
+        else
+        {
+            ok = false;
+        }
+        if (!ok)
+        {
+            std::cerr << "Error: unknown option " << argv[a] << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
 
     //printf("start main \n");
 
+    if (pool_threads >= 0 && (virtual_time || sweep))
+    {
+        std::cerr << "Error: --pool only applies to real-time runs" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (trace_file != NULL)
+    {
+#ifdef SCHED_TRACE
+        if (virtual_time || sweep)
+        {
+            std::cerr << "Error: --trace only applies to real-time runs" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // trace events land on per-thread tracks named after the cores
+        if (pool_threads >= 0)
+        {
+            std::cerr << "Error: --trace needs a thread per core (drop --pool)" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        Trace::enable(1 << 20);
+#else
+        std::cerr << "Error: built without tracing (rebuild with make TRACE=1)" << std::endl;
+        exit(EXIT_FAILURE);
+#endif
+    }
+
+#ifdef SCHED_PROFILE
+    if (profile && (virtual_time || sweep))
+    {
+        std::cerr << "Error: --profile only applies to real-time runs" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+#else
+    if (profile)
+    {
+        std::cerr << "Error: built without profiling (rebuild with make PROFILE=1)" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+#endif
+
     // Declare variables used throughout main
     int i;
     SchedulerData *shared_data;
-    std::vector<Process*> processes;
 
     // Read configuration file for scheduling simulation
-    SchedulerConfig *config = readConfigFile(argv[1]);
+    std::string error;
+    SchedulerConfig *config = loadWorkload(argv[1], error);
+    if (config == NULL)
+    {
+        std::cerr << "Error: " << argv[1] << ": " << error << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    config->migration_penalty = migration_penalty;
+    config->affinity_wait = affinity_wait;
+    config->speed_placement = speed_placement;
+    if (!io_devices.empty())
+    {
+        config->num_io_devices = io_devices.size();
+        config->io_devices = new IoDeviceSpec[io_devices.size()];
+        std::copy(io_devices.begin(), io_devices.end(), config->io_devices);
+    }
+
+    if (sweep)
+    {
+        // anything not swept keeps the workload's own value
+        if (sweep_params.algorithms.empty()) sweep_params.algorithms.push_back(config->algorithm);
+        if (sweep_params.cores.empty()) sweep_params.cores.push_back(config->cores);
+        if (sweep_params.time_slices.empty()) sweep_params.time_slices.push_back(config->time_slice);
+        if (sweep_params.context_switches.empty()) sweep_params.context_switches.push_back(config->context_switch);
+        std::vector<SweepResult> results = runSweep(config, sweep_params);
+        if (sweep_json)
+        {
+            printSweepJson(stdout, results);
+        }
+        else
+        {
+            printSweepCsv(stdout, results);
+        }
+        deleteConfig(config);
+        return 0;
+    }
 
     //printf("read configure file \n");
 
     // Store configuration parameters in shared data object
     // put mutex locks here?? 03/31/2021
-    uint8_t num_cores = config->cores;
+    uint16_t num_cores = config->cores;
     shared_data = new SchedulerData();
     shared_data->algorithm = config->algorithm;
     shared_data->context_switch = config->context_switch;
-    shared_data->time_slice = config->time_slice;
-    shared_data->all_terminated = false;
-
-    // Create processes
-    uint64_t start = currentTime();
-
-
-    
-    for (i = 0; i < config->num_processes; i++)
+    shared_data->migration_penalty = config->migration_penalty;
+    shared_data->run_queues = new RunQueues(queue_mode, config->algorithm, num_cores, config->affinity_wait);
+    std::vector<CoreUsage> usage = coreUsage(config);
+    if (config->speed_placement)
     {
-        Process *p = new Process(config->processes[i], start);
-        processes.push_back(p);
-        // If process should be launched immediately, add to ready queue
-        if (p->getState() == Process::State::Ready)
-        {
-            
-            
-            {
-                std::lock_guard<std::mutex>lock(shared_data->mutex);
-                shared_data->ready_queue.push_back(p);
-                //std::lock_guard<std::mutex>unlock(shared_data->mutex);
-            }
-        }
+        shared_data->run_queues->placeBySpeed(usage);
     }
-
-    // Free configuration data from memory
-    deleteConfig(config);
-    
-
-    // Launch 1 scheduling thread per cpu core
-    std::thread *schedule_threads = new std::thread[num_cores];
+    if (pool_threads >= 0)
+    {
+        shared_data->executor = new PoolExecutor((pool_threads > 0) ? pool_threads : std::thread::hardware_concurrency());
+    }
+    else
+    {
+        shared_data->executor = new ThreadExecutor(num_cores);
+    }
+    shared_data->run_queues->setWaker(shared_data->executor);
+    shared_data->running = new std::atomic<Process*>[num_cores];
     for (i = 0; i < num_cores; i++)
     {
-        schedule_threads[i] = std::thread(coreRunProcesses, i, shared_data ); //i, shared_data
+        shared_data->running[i] = NULL;
     }
+    shared_data->num_terminated = 0;
+    shared_data->all_terminated = false;
+    shared_data->latencies = new SchedulingLatencies[shared_data->executor->workers()];
+    shared_data->usage = &usage[0];
 
-    
+    // Create processes (taking over the config's burst times)
+    uint64_t start = virtual_time ? 0 : currentTime();
+    ProcessTable processes(config, start);
+    SchedulingLatencies latencies;
+    IoDevices devices(config);
+    uint64_t makespan;
 
-    // Main thread work goes here
-    int num_lines = 0;
-    while (!(shared_data->all_terminated))
+    if (virtual_time)
     {
-
-        
-        // Clear output from previous iteration
-        clearOutput(num_lines);
-
-        // Do the following:
-        //   - Get current time
-        uint64_t cTime = currentTime();
-
-        
-        for(int i = 0; i < processes.size(); i++){//go through each process
-            
-            //printf("going through processes and conditions \n");
-
-            processes[i]->updateProcess(cTime); 
-            //   - *Check if any processes need to move from NotStarted to Ready (based on elapsed time), and if so put that process in the ready queue
-            if((processes[i]->getStartTime() < (cTime - start))&& processes[i]->getLastState() == processes[i]->NotStarted){ 
-                
-
-                
-                {
-                    std::lock_guard<std::mutex>lock(shared_data->mutex);
-                    processes[i]->setState(processes[i]->Ready,cTime);
-                    shared_data->ready_queue.push_back(processes[i]);
-                    //std::lock_guard<std::mutex>unlock(shared_data->mutex);
-                }
-            }
-
-
-
-            //   - *Check if any processes have finished their I/O burst, and if so put that process back in the ready queue
-            //If it finishes IO does it go bacj to ready state?
-            else if((processes[i]->getState() == processes[i]->IO) && processes[i]->getCurrentBurstTime() < (cTime - processes[i]->getBurstStartTime()) ){ //maybe check this
-                
-                //printf("else if statement inside processes \n");
-
-                {
-                    std::lock_guard<std::mutex>lock(shared_data->mutex);
-                    shared_data->ready_queue.push_back(processes[i]);
-                    //processes[i]->setBurstStartTime(cTime);
-                    
-                    
-                    processes[i]->incrementBurstIdx();
-                    
-                    processes[i]->setState(processes[i]->Ready,cTime);
-                    //std::lock_guard<std::mutex>unlock(shared_data->mutex);
-                }
-
-
-            }
-            //   - *Check if any running process need to be interrupted (RR time slice expires or newly ready process has higher priority)
-            
-            if(processes[i]->getState() == processes[i]->Running){
-                {
-                    //printf("running state \n");
-
-                    std::lock_guard<std::mutex>lock(shared_data->mutex);
-                    
-                    if(shared_data->algorithm == RR && (shared_data->time_slice <= cTime - processes[i]->getBurstStartTime())){
-                        processes[i]->interrupt();
-
-                    }
-
-                    bool shouldInterrupt = false;
-
-                    for(int j = 0; j < processes.size(); j++){
-                        
-                        if (processes[i]->getPriority() < processes[j]->getPriority()){
-                            
-                            shouldInterrupt = true;
-                        }
-                    }
-                    if(shared_data->algorithm == PP && shouldInterrupt){
-                        
-                        processes[i]->interrupt();
-                    }
-                    //std::lock_guard<std::mutex>unlock(shared_data->mutex);
-
-
-                    //need to handle interupt here?
-                }
-            }
-
-        }
-        
-        
-        //   - *Sort the ready queue (if needed - based on scheduling algorithm)
-    
-        if(shared_data->algorithm == SJF){
-            shared_data->ready_queue.sort(SjfComparator());
-        }
-        else if(shared_data->algorithm == PP){
-            shared_data->ready_queue.sort(PpComparator());
+        // Discrete-event simulation: virtual clock starts at 0 and jumps from
+        // event to event, so no sleeping and no scheduling threads are needed
+        Simulator simulator(config, processes);
+        deleteConfig(config);
+        simulator.run();
+        makespan = simulator.currentTime();
+        latencies.merge(simulator.schedulingLatencies());
+        usage = simulator.coreUsage();
+        devices = simulator.ioDevices();
+        if (!headless)
+        {
+            printProcessOutput(processes, simulator.currentTime());
         }
-
-        
-
-        //   - Determine if all processes are in the terminated state
+        if (shared_data->algorithm == PP)
         {
-            std::lock_guard<std::mutex>unlock(shared_data->mutex);
-            if(shared_data->all_terminated){
-                
-                return 0;
-            }
-        }       
-        //   - * = accesses shared data (ready queue), so be sure to use proper synchronization
-
-        // output process status table
-        num_lines = printProcessOutput(processes, shared_data->mutex);
-        
-
-        
-
-
-
-
-        // sleep 50 ms
-        usleep(50000);
+            printf("Preemptions issued: %" PRIu64 " (%.2f/s)\n", simulator.preemptionCount(),
+                   simulator.preemptionCount() * 1000.0 / simulator.currentTime());
+        }
     }
-
-
-    // wait for threads to finish
-    for (i = 0; i < num_cores; i++)
+    else
     {
-        schedule_threads[i].join();
+        StatusDisplay display(stdout, refresh_interval);
+        RealTimeRun real_time = { config, &processes, start, shared_data, &devices, headless ? NULL : &display };
+#ifdef SCHED_PROFILE
+        if (profile)
+        {
+            Profile::enable(num_cores);
+        }
+#endif
+        withPolicy(config->algorithm, real_time);
+        makespan = currentTime() - start;
+        for (i = 0; i < shared_data->executor->workers(); i++)
+        {
+            latencies.merge(shared_data->latencies[i]);
+        }
+#ifdef SCHED_TRACE
+        if (trace_file != NULL && !Trace::writeChromeTrace(trace_file))
+        {
+            std::cerr << "Error: cannot write trace to " << trace_file << std::endl;
+        }
+#endif
     }
 
 
-
-
     // print final statistics
 
     
     double cpuTotal = 0;
     double totalTurn = 0;
-    double turnArray[processes.size()];
+    std::vector<double> turnArray(processes.size());
     double totalWait = 0;
     for(int j = 0; j < processes.size(); j++){
 
-            cpuTotal = cpuTotal + processes[j]->getCpuTime();
-            totalTurn = totalTurn + processes[j]->getTurnaroundTime();
-            turnArray[j] = processes[j]->getTurnaroundTime();
-            totalWait = totalWait + processes[j]->getWaitTime();
+            cpuTotal = cpuTotal + processes[j].getCpuTime();
+            totalTurn = totalTurn + processes[j].getTurnaroundTime();
+            turnArray[j] = processes[j].getTurnaroundTime();
+            totalWait = totalWait + processes[j].getWaitTime();
     }
 
-    int n = sizeof(turnArray)/sizeof(turnArray[0]);
-    std::sort(turnArray,turnArray+n);
+    int n = turnArray.size();
+    std::sort(turnArray.begin(),turnArray.end());
 
     //  - CPU utilization
     double cpuUtil = cpuTotal/totalTurn;
@@ -282,201 +425,511 @@ int main(int argc, char **argv)
     //  - Average waiting time
     double waitAvg = totalWait/processes.size();
     printf("Average wait time is %f\n", waitAvg);
+    latencies.print(stdout);
+    // every stretch on a core ends in a context switch
+    printSwitchCosts(processes, latencies.dispatch.count(), shared_data->context_switch,
+                     shared_data->migration_penalty, num_cores, makespan);
+    printCoreUsage(stdout, usage, start, makespan);
+    devices.print(stdout, makespan);
+    printf("Process memory: %zu bytes (%zu per process + %zu of burst times)\n",
+           processes.processBytes() + processes.burstBytes(), sizeof(Process), processes.burstBytes());
+#ifdef SCHED_PROFILE
+    if (profile)
+    {
+        Profile::print(stdout);
+    }
+#endif
     // Clean up before quitting program
-    processes.clear();
+    delete shared_data->run_queues;
+    delete shared_data->executor;
+    delete[] shared_data->running;
+    delete[] shared_data->latencies;
+    delete shared_data;
 
     return 0;
 }
 
-void coreRunProcesses(uint8_t core_id, SchedulerData *shared_data)
+// `display` shows the live process table (NULL when headless). I/O devices
+// belong to the monitor: it submits each new I/O burst to its device and,
+// when one finishes, starts the next request queued there, so device service
+// starts and ends are as coarse as its ticks.
+template <typename Policy>
+void runRealTime(SchedulerConfig *config, ProcessTable& processes, uint64_t start, SchedulerData *shared_data,
+                 IoDevices *io_devices, StatusDisplay *display)
 {
-    // Work to be done by each core idependent of the other cores
-    // Repeat until all processes in terminated state:
+    int i;
+    uint16_t num_cores = config->cores;
 
-    uint64_t curTime = currentTime();
+    // Timers for launch times and I/O burst ends, so each tick only visits processes that are due
+    TimerWheel timers(start);
+    TRACE_THREAD("monitor", num_cores);
+    uint64_t preemptions = 0;
+    uint64_t renders = 0;
+    std::chrono::duration<double, std::milli> render_time(0);
 
-    while(!shared_data->all_terminated){
 
-        
+    
+    std::vector<Process*> launched;
+    for (i = 0; i < config->num_processes; i++)
+    {
+        Process *p = &processes[i];
+        // If process should be launched immediately, add to ready queue
+        if (p->getState() == Process::State::Ready)
+        {
+            TRACE_EVENT(TraceArrival, p->getPid(), -1);
+            launched.push_back(p);
+        }
+        else
+        {
+            timers.add(start + p->getStartTime(), p);
+        }
+    }
+    shared_data->run_queues->enqueueBatch(launched);
 
-        //   - *Get process at front of ready queue
-        
-        Process *currPro;
-        
-            
-            if(!shared_data->ready_queue.empty())
-            {
-                std::lock_guard<std::mutex>lock(shared_data->mutex);
-                currPro = shared_data->ready_queue.front();
-                shared_data->ready_queue.pop_front();
-                currPro->setCpuCore(core_id);
-                currPro->setBurstStartTime(curTime);
-                
-            
-                //std::lock_guard<std::mutex>unlock(shared_data->mutex);
+    // Free configuration data from memory
+    Policy policy(config);
+    deleteConfig(config);
+    
 
-            }
-           
-        
+    // Start the cores: 1 scheduling thread each, or multiplexed on the --pool threads
+    std::vector<CoreTask*> cores;
+    for (i = 0; i < num_cores; i++)
+    {
+        cores.push_back(new SimulatedCore<Policy>(i, shared_data, &policy));
+    }
+    shared_data->executor->start(cores);
 
     
-        //   - Simulate the processes running until one of the following:
-        currPro->setState(currPro->Running, curTime);
-        currPro->incrementBurstIdx();
-        currPro->setBurstStartTime(curTime);
-        
-        bool isEmpty;
-        bool isTerminated;
+
+    // Main thread work goes here
+    uint64_t next_boost = start + policy.boostInterval();
+    while (!(shared_data->all_terminated))
+    {
+
+        // Do the following:
+        //   - Get current time
+        uint64_t cTime = currentTime();
+        RunQueues *run_queues = shared_data->run_queues;
+
+        // pick up processes that started an I/O burst since the last tick
+        std::vector<Process*> io_started;
         {
-            std::lock_guard<std::mutex>lock(shared_data->mutex);
-            isEmpty = shared_data->ready_queue.empty();
-            isTerminated = shared_data->all_terminated;
+            std::unique_lock<ProfiledMutex> lock = lockAt(shared_data->io_mutex, LOCK_SITE("monitor: I/O started"));
+            io_started.swap(shared_data->io_started);
+        }
+        for(int i = 0; i < io_started.size(); i++){
+            Process *p = io_started[i];
+            if(!io_devices->enabled() || io_devices->deviceOf(p).submit(p, p->getBurstStartTime())){
+                timers.add(p->getBurstStartTime() + p->getCurrentBurstTime(), p);
+            }
+        }
+
+        //   - *Check if any processes need to move from NotStarted to Ready (based on elapsed time), and if so put that process in the ready queue
+        //   - *Check if any processes have finished their I/O burst, and if so put that process back in the ready queue
+        // (both are monitor-owned while waiting, so no lock is needed until they are all queued at once)
+        std::vector<Process*> due;
+        timers.advance(cTime, due);
+        for(int i = 0; i < due.size(); i++){
+            Process *p = due[i];
+            if(p->getState() == p->IO){
+                if(io_devices->enabled()){
+                    Process *next = io_devices->deviceOf(p).finish(cTime);
+                    if(next != NULL){
+                        timers.add(cTime + next->getCurrentBurstTime(), next);
+                    }
+                }
+                p->incrementBurstIdx();
+                TRACE_EVENT(TraceIoEnd, p->getPid(), -1);
+            }
+            else{
+                TRACE_EVENT(TraceArrival, p->getPid(), -1);
+            }
+            p->setState(p->Ready,cTime);
+        }
+        run_queues->enqueueBatch(due);
+
+        //   - *Check if any running process need to be interrupted (newly ready process has higher priority)
+        // (time slices are enforced by the core threads themselves)
+        // PP: the tracker knows the highest ready priority and the lowest
+        // priority running core, so it names exactly the cores to interrupt
+        if(Policy::PRIORITY_PREEMPTION){
+            std::vector<uint16_t> victims;
+            run_queues->priorityTracker()->selectVictims(victims);
+            for(int v = 0; v < victims.size(); v++){
+                int c = victims[v];
+                Process *p = shared_data->running[c];
+                if(p == NULL){
+                    continue;
+                }
+                std::unique_lock<ProfiledMutex> lock = run_queues->lockProcess(p, LOCK_SITE("monitor: preempt"));
+                if(p->getState() == p->Running && p->getCpuCore() == c && !p->isInterrupted()){
+                    TRACE_EVENT(TraceInterrupt, p->getPid(), c);
+                    p->interrupt();
+                    shared_data->executor->wake(c);
+                    preemptions++;
+                }
+            }
         }
         
-        while(!isEmpty){ //PROBLEM
-        //continue running until all processes are either terminated or no more processes on either queue??
-        //-- Kong's comment
-        // this is okay and resolved for now -- 04/02/2021
-
-            //printf("inwhile\n");
-
-            uint64_t elapsed = curTime -currPro->getBurstStartTime();
-
-            //     - CPU burst time has elapsed
-            if(elapsed > currPro->getCurrentBurstTime() && currPro->getState() == currPro->Running){ 
-                //switch to IO or terminated
-                
-                
-
-                if(currPro->getRemainingTime() > 0){
-                    currPro->setState(currPro->IO, curTime);
-                    currPro->incrementBurstIdx();
-                    currPro->setBurstStartTime(curTime);
-                    
+        
+        //   - Ready queue keeps itself ordered (heap for SJF/PP, levels for MLFQ), no sorting needed
+        // MLFQ: periodically put every process back on the top level. Each
+        // one is changed by its current owner's rules: queued and running
+        // processes under their queue's lock, the rest directly
+        if(Policy::PERIODIC_BOOST && cTime >= next_boost){
+            for(int c = 0; c < num_cores; c++){
+                Process *p = shared_data->running[c];
+                if(p != NULL){
+                    std::unique_lock<ProfiledMutex> lock = run_queues->lockProcess(p, LOCK_SITE("monitor: boost"));
+                    p->setLevel(0);
                 }
-                else{
-                    currPro->setState(currPro->Terminated, curTime);
-                    currPro->setCpuCore(-1);
+            }
+            for(int j = 0; j < processes.size(); j++){
+                if(processes[j].getRunQueue() < 0){
+                    processes[j].setLevel(0);
                 }
             }
-            
-            //     - Interrupted (RR time slice has elapsed or process preempted by higher priority process)
-            //double check this!!
+            run_queues->boost();
+            next_boost = cTime + policy.boostInterval();
+        }
 
-            {
-                std::lock_guard<std::mutex>lock(shared_data->mutex);
-                if((shared_data->time_slice > elapsed && shared_data->algorithm == RR) || ((currPro->getPriority() > shared_data->ready_queue.front()->getPriority()) &&  shared_data->algorithm == PP)){
-                    //go back to ready
-                    
-                    
-                
-                
-                    currPro->setState(currPro->Ready, curTime);
-                    //maybe update bursttime?
-                    shared_data->ready_queue.push_back(currPro);
+        
 
-                }
+        //   - Determine if all processes are in the terminated state
+        bool all_terminated = (shared_data->num_terminated == processes.size());
+        shared_data->all_terminated = all_terminated;
+        if (all_terminated)
+        {
+            run_queues->wakeAll();
+        }
+        //   - * = accesses shared data (ready queue), so be sure to use proper synchronization
+
+        // output process status table (at most once per refresh interval)
+        if (display != NULL && !all_terminated)
+        {
+            std::chrono::steady_clock::time_point render_start = std::chrono::steady_clock::now();
+            if (display->update(processes, cTime))
+            {
+                render_time += std::chrono::steady_clock::now() - render_start;
+                renders++;
             }
-            
         }
-    
         
 
-    //  - Place the process back in the appropriate queue
-    
-    //     - I/O queue if CPU burst finished (and process not finished) -- no actual queue, simply set state to IO
-    //State state; 
-    // double check this - 04/01/2021
-    
-    if(((curTime - currPro->getBurstStartTime()) > currPro->getCurrentBurstTime()) && currPro->getState() == currPro->Running){
+        
+
+
 
-            currPro->setState(currPro->IO, curTime);
-            
-            currPro->incrementBurstIdx();
-            currPro->setBurstStartTime(curTime);
 
-            
+        // sleep 50 ms
+        if (!all_terminated)
+        {
+            usleep(50000);
+        }
     }
-    
-    //     - Terminated if CPU burst finished and no more bursts remain -- no actual queue, simply set state to Terminated
-    // double check this - 04/01/2021
-    if(((curTime - currPro->getBurstStartTime()) > currPro->getCurrentBurstTime()) && currPro->isLastBurst() && currPro->getState() == currPro->Running){
-            
-            
 
-            currPro->setState(currPro->Terminated, curTime);
+
+    // wait for the cores to finish
+    shared_data->executor->join();
+    for (i = 0; i < num_cores; i++)
+    {
+        delete cores[i];
+    }
+
+    // the live table gives way to the final one
+    if (display != NULL)
+    {
+        display->clear();
+        printProcessOutput(processes, currentTime());
     }
 
-    //     - *Ready queue if interrupted (be sure to modify the CPU burst time to now reflect the remaining time)
-    //finished up this if statement - 04/02/21
-    if(currPro->isInterrupted()){
+    // lock contention summary, to compare the run queue layouts
+    RunQueues *run_queues = shared_data->run_queues;
+    double elapsed = (currentTime() - start) / 1000.0;
+    uint64_t acquisitions = run_queues->lockAcquisitions();
+    uint64_t contended = run_queues->contendedAcquisitions();
+    double host_cpu = (double)std::clock() / CLOCKS_PER_SEC;
+    printf("Simulator host CPU time: %.2f s over %.2f s elapsed\n", host_cpu, elapsed);
+    printf("Run queues (%s): %" PRIu64 " lock acquisitions (%.0f/s), %" PRIu64 " contended (%.2f%%, %.1f ms blocked), %" PRIu64 " steals\n",
+           runQueueModeToString(run_queues->getMode()), acquisitions, acquisitions / elapsed, contended,
+           (acquisitions > 0) ? 100.0 * contended / acquisitions : 0.0, run_queues->blockedNanos() / 1e6,
+           run_queues->stealCount());
+    shared_data->executor->printStats(stdout);
+    if (renders > 0)
+    {
+        printf("Status display: %" PRIu64 " renders, %.2f ms each on average\n", renders,
+               render_time.count() / renders);
+    }
+    if (Policy::PRIORITY_PREEMPTION)
+    {
+        printf("Preemptions issued: %" PRIu64 " (%.2f/s)\n", preemptions, preemptions / elapsed);
+    }
+}
 
+// One simulated core, stepped by the core executor (a thread of its own, or
+// a slot in the --pool thread pool). Each step carries on from the phase the
+// core was left in and returns when it next needs to run.
+template <typename Policy>
+class SimulatedCore : public CoreTask {
+private:
+    enum Phase : uint8_t { Idle, Migrating, Running, Switching };
+
+    uint16_t core_id;
+    SchedulerData *shared_data;
+    const Policy *policy;
+    Phase phase;
+    Process *currPro;
+    Process *reserved[Policy::DISPATCH_BATCH];  // taken from the queue, still to be dispatched in order
+    uint32_t num_reserved;
+    uint32_t next_reserved;
+    uint64_t slice;
+    uint64_t resume_at;     // end of the migration or context switch
+    bool parked;
+
+    void dispatch(uint64_t now, uint32_t worker)
+    {
+        RunQueues *run_queues = shared_data->run_queues;
         {
-            std::lock_guard<std::mutex>lock(shared_data->mutex);
+            std::unique_lock<ProfiledMutex> lock = run_queues->lockProcess(currPro, LOCK_SITE("core: dispatch"));
+            currPro->interruptHandled();
+            currPro->setCpuCore(core_id);
+            currPro->setCoreSpeed(shared_data->usage[core_id].speed);
+            shared_data->latencies[worker].dispatched(currPro, now);
+            currPro->setState(currPro->Running, now);
+            currPro->setBurstStartTime(now);
+            shared_data->running[core_id] = currPro;
+            PROFILE_ACTIVITY(core_id, Running, now);
+            TRACE_EVENT(TraceDispatch, currPro->getPid(), core_id);
+            if(Policy::PRIORITY_PREEMPTION){
+                run_queues->priorityTracker()->runningStarted(core_id, currPro->getPriority());
+            }
+        }
+        slice = Policy::TIME_SLICED ? policy->timeSlice(currPro, run_queues->runnable(core_id)) : 0;
+        phase = Running;
+    }
 
-            currPro->setState(currPro->Ready, curTime);
-            shared_data->ready_queue.push_back(currPro);
+    // Running: false (and the time to look again) while the process keeps the core
+    bool stopRunning(uint64_t now, uint32_t worker, uint64_t *until)
+    {
+        RunQueues *run_queues = shared_data->run_queues;
+        CoreUsage& usage = shared_data->usage[core_id];
+        std::unique_lock<ProfiledMutex> lock = run_queues->lockProcess(currPro, LOCK_SITE("core: run check"));
+        uint64_t elapsed = now - currPro->getBurstStartTime();
+        uint64_t burst = runTimeOnCore(currPro->getCurrentBurstTime(), usage.speed);
+
+        //     - CPU burst time has elapsed (at this core's speed)
+        if(elapsed >= burst){
+            //  - Place the process back in the appropriate queue
+            //     - Terminated if CPU burst finished and no more bursts remain -- no actual queue, simply set state to Terminated
+            bool terminated = currPro->isLastBurst();
+            TRACE_EVENT(TraceBurstEnd, currPro->getPid(), core_id);
+            policy->ran(currPro, elapsed);
+            recordCoreBusy(usage, currPro->getBurstStartTime(), now);
+            if(terminated){
+                currPro->setState(currPro->Terminated, now);
+                shared_data->latencies[worker].terminated(currPro);
+                TRACE_EVENT(TraceTerminate, currPro->getPid(), core_id);
+            }
+            //     - I/O queue if CPU burst finished (and process not finished) -- no actual queue, simply set state to IO
+            else{
+                policy->blocked(currPro);
+                currPro->incrementBurstIdx();
+                currPro->setState(currPro->IO, now);
+                currPro->setBurstStartTime(now);
+                TRACE_EVENT(TraceIoStart, currPro->getPid(), core_id);
+            }
+            currPro->setCpuCore(-1);
+            shared_data->running[core_id] = NULL;
+            if(Policy::PRIORITY_PREEMPTION){
+                run_queues->priorityTracker()->runningStopped(core_id);
+            }
+            run_queues->release(currPro);
+            lock.unlock();
+            // hand the process back to the monitor
+            if(terminated){
+                shared_data->num_terminated++;
+            }
+            else{
+                std::unique_lock<ProfiledMutex> io_lock = lockAt(shared_data->io_mutex, LOCK_SITE("core: I/O started"));
+                shared_data->io_started.push_back(currPro);
+            }
+            return true;
+        }
+        //     - Interrupted (time slice has elapsed or process preempted by higher priority process)
+        //     - *Ready queue if interrupted (be sure to modify the CPU burst time to now reflect the remaining time)
+        if((Policy::TIME_SLICED && elapsed >= slice) || currPro->isInterrupted()){
+            policy->ran(currPro, elapsed);
+            recordCoreBusy(usage, currPro->getBurstStartTime(), now);
+            currPro->updateBurstTime(currPro->get_current_burst_id(),
+                                     workLeftOnCore(currPro->getCurrentBurstTime(), elapsed, usage.speed));
+            if(Policy::TIME_SLICED && elapsed >= slice){
+                policy->sliceExpired(currPro);
+            }
+            currPro->interruptHandled();
+            TRACE_EVENT(TracePreempt, currPro->getPid(), core_id);
+            currPro->setState(currPro->Ready, now);
+            currPro->setCpuCore(-1);
+            shared_data->running[core_id] = NULL;
+            if(Policy::PRIORITY_PREEMPTION){
+                run_queues->priorityTracker()->runningStopped(core_id);
+            }
+            run_queues->pushLocked(run_queues->queueOf(core_id), currPro);
+            return true;
+        }
+        //     - Otherwise look again when the burst (or slice) is due to finish, unless the monitor interrupts us first
+        *until = burst;
+        if(Policy::TIME_SLICED && slice < *until){
+            *until = slice;
+        }
+        *until += currPro->getBurstStartTime();
+        return false;
+    }
 
-            uint64_t modifiedCPUBurstTime = currPro->getRemainingTime();
+    // One step: carry on from the current phase until the core has to wait
+    uint64_t advance(uint64_t now, uint32_t worker)
+    {
+        RunQueues *run_queues = shared_data->run_queues;
+        while(true){
+            switch(phase){
+                case Idle:
+                    // Repeat until all processes in terminated state
+                    if(shared_data->all_terminated){
+                        PROFILE_ACTIVITY(core_id, Stopped, now);
+                        return FINISHED;
+                    }
+                    //   - *Get process at front of ready queue (or steal one from another core),
+                    //     reserving the next few as well if the policy allows
+                    if(next_reserved == num_reserved){
+                        num_reserved = run_queues->hasWork(core_id) ?
+                            run_queues->takeBatch(core_id, reserved, Policy::DISPATCH_BATCH) : 0;
+                        next_reserved = 0;
+                    }
+                    currPro = (next_reserved < num_reserved) ? reserved[next_reserved++] : NULL;
+                    if(currPro == NULL){
+                        // nothing to run: wait until work is queued (or the run ends)
+                        parked = run_queues->park(core_id);
+                        if(parked){
+                            uint64_t deadline = run_queues->parkedUntil();
+                            return (deadline == UINT64_MAX) ? WAIT : deadline;
+                        }
+                        continue;
+                    }
+                    if(parked){
+                        run_queues->unpark(core_id);
+                        parked = false;
+                    }
+                    //   - Resuming on a different core: warm the caches up first (the process is still waiting)
+                    if(shared_data->migration_penalty > 0 && currPro->getLastCore() >= 0 && currPro->getLastCore() != core_id){
+                        TRACE_EVENT(TraceSwitchStart, currPro->getPid(), core_id);
+                        PROFILE_ACTIVITY(core_id, Switching, now);
+                        phase = Migrating;
+                        resume_at = now + shared_data->migration_penalty;
+                        return resume_at;
+                    }
+                    dispatch(now, worker);
+                    break;
+                case Migrating:
+                    if(now < resume_at){
+                        return resume_at;
+                    }
+                    TRACE_EVENT(TraceSwitchEnd, currPro->getPid(), core_id);
+                    dispatch(now, worker);
+                    break;
+                case Running:
+                    //   - Simulate the process running until it finishes its burst or is interrupted
+                    {
+                        uint64_t until;
+                        if(!stopRunning(now, worker, &until)){
+                            return until;
+                        }
+                    }
+                    //  - Wait context switching time
+                    TRACE_EVENT(TraceSwitchStart, 0, core_id);
+                    PROFILE_ACTIVITY(core_id, Switching, now);
+                    currPro = NULL;
+                    phase = Switching;
+                    resume_at = now + shared_data->context_switch;
+                    break;
+                case Switching:
+                    if(now < resume_at){
+                        return resume_at;
+                    }
+                    TRACE_EVENT(TraceSwitchEnd, 0, core_id);
+                    PROFILE_ACTIVITY(core_id, Idle, now);
+                    phase = Idle;
+                    break;
+            }
+        }
+    }
 
-            currPro->updateBurstTime(currPro->get_current_burst_id(), modifiedCPUBurstTime);
+public:
+    SimulatedCore(uint16_t core_id, SchedulerData *shared_data, const Policy *policy) :
+        core_id(core_id), shared_data(shared_data), policy(policy), phase(Idle), currPro(NULL),
+        num_reserved(0), next_reserved(0), slice(0), resume_at(0), parked(false) {}
 
-            //std::lock_guard<std::mutex>unlock(shared_data->mutex);
+    // lock waits during the step are charged to this core
+    uint64_t step(uint64_t now, uint32_t worker)
+    {
+        PROFILE_CORE(core_id);
+        uint64_t next = advance(now, worker);
+        PROFILE_CORE(-1);
+        return next;
+    }
+};
 
+// Core time spent switching instead of running processes, and how often
+// processes changed cores
+void printSwitchCosts(ProcessTable& processes, uint64_t switches, uint32_t context_switch,
+                      uint32_t migration_penalty, uint16_t cores, uint64_t makespan)
+{
+    size_t i;
+    uint64_t migrations = 0;
+    size_t most = 0;
+    for (i = 0; i < processes.size(); i++)
+    {
+        migrations += processes[i].getMigrations();
+        if (processes[i].getMigrations() > processes[most].getMigrations())
+        {
+            most = i;
         }
-        
-        
     }
-    
-    //  - Wait context switching time
-    // sleeps for 500 miliseconds
-    
-    usleep(500000);
-
-    //  - * = accesses shared data (ready queue), so be sure to use proper synchronization
+    uint64_t lost = switches * context_switch + migrations * migration_penalty;
+    uint64_t core_time = (uint64_t)cores * makespan;
+    printf("Switch costs: %" PRIu64 " context switches (%" PRIu64 " ms), %" PRIu64 " migrations (%" PRIu64 " ms), "
+           "%.1f%% of core time lost\n", switches, switches * context_switch, migrations,
+           migrations * migration_penalty, (core_time > 0) ? 100.0 * lost / core_time : 0.0);
+    if (processes.size() > 0)
+    {
+        printf("Migrations per process: %.2f on average, at most %u (pid %u)\n",
+               (double)migrations / processes.size(), processes[most].getMigrations(), processes[most].getPid());
     }
 }
 
-int printProcessOutput(std::vector<Process*>& processes, std::mutex& mutex)
+// Final table of every process (each one read through its lock-free snapshot)
+void printProcessOutput(ProcessTable& processes, uint64_t current_time)
 {
     int i;
-    int num_lines = 2;
-    std::lock_guard<std::mutex> lock(mutex);
     printf("|   PID | Priority |      State | Core | Turn Time | Wait Time | CPU Time | Remain Time |\n");
     printf("+-------+----------+------------+------+-----------+-----------+----------+-------------+\n");
     for (i = 0; i < processes.size(); i++)
     {
-        if (processes[i]->getState() != Process::State::NotStarted)
-        {
-            uint16_t pid = processes[i]->getPid();
-            uint8_t priority = processes[i]->getPriority();
-            std::string process_state = processStateToString(processes[i]->getState());
-            int8_t core = processes[i]->getCpuCore();
-            std::string cpu_core = (core >= 0) ? std::to_string(core) : "--";
-            double turn_time = processes[i]->getTurnaroundTime();
-            double wait_time = processes[i]->getWaitTime();
-            double cpu_time = processes[i]->getCpuTime();
-            double remain_time = processes[i]->getRemainingTime();
+        Process& p = processes[i];
+        Process::Snapshot snap = p.snapshot(current_time);
+        if (snap.state != Process::State::NotStarted)
+        {
+            uint32_t pid = p.getPid();
+            uint8_t priority = p.getPriority();
+            std::string process_state = processStateToString(snap.state);
+            std::string cpu_core = (snap.core >= 0) ? std::to_string(snap.core) : "--";
+            double turn_time = snap.turn_time / 1000.0;
+            double wait_time = snap.wait_time / 1000.0;
+            double cpu_time = snap.cpu_time / 1000.0;
+            double remain_time = snap.remain_time / 1000.0;
             printf("| %5u | %8u | %10s | %4s | %9.1lf | %9.1lf | %8.1lf | %11.1lf |\n", 
                    pid, priority, process_state.c_str(), cpu_core.c_str(), turn_time, 
                    wait_time, cpu_time, remain_time);
-            num_lines++;
         }
     }
-    return num_lines;
-}
-
-void clearOutput(int num_lines)
-{
-    int i;
-
-    for (i = 0; i < num_lines; i++)
-    {
-        fputs("\033[A\033[2K", stdout);
-    }
-
-    rewind(stdout);
-    fflush(stdout);
 }
 
 uint64_t currentTime()
@@ -485,30 +938,3 @@ uint64_t currentTime()
                   std::chrono::system_clock::now().time_since_epoch()).count();
     return ms;
 }
-
-std::string processStateToString(Process::State state)
-{
-    std::string str;
-    switch (state)
-    {
-        case Process::State::NotStarted:
-            str = "not started";
-            break;
-        case Process::State::Ready:
-            str = "ready";
-            break;
-        case Process::State::Running:
-            str = "running";
-            break;
-        case Process::State::IO:
-            str = "i/o";
-            break;
-        case Process::State::Terminated:
-            str = "terminated";
-            break;
-        default:
-            str = "unknown";
-            break;
-    }
-    return str;
-}
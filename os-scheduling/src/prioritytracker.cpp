@@ -0,0 +1,183 @@
+#include "prioritytracker.h"
+
+// PriorityTracker class methods
+PriorityTracker::PriorityTracker(uint16_t num_cores)
+{
+    uint32_t i;
+    this->num_cores = num_cores;
+    core_words = (num_cores + 63) / 64;
+    running_cores = new std::atomic<uint64_t>[LEVELS * core_words];
+    core_priority = new std::atomic<int16_t>[num_cores];
+    for (i = 0; i < LEVELS; i++)
+    {
+        ready_count[i] = 0;
+        running_count[i] = 0;
+    }
+    for (i = 0; i < LEVELS * core_words; i++)
+    {
+        running_cores[i] = 0;
+    }
+    for (i = 0; i < num_cores; i++)
+    {
+        core_priority[i] = IDLE;
+    }
+    ready_bitmap = 0;
+    running_bitmap = 0;
+    num_running = 0;
+}
+
+PriorityTracker::~PriorityTracker()
+{
+    delete[] running_cores;
+    delete[] core_priority;
+}
+
+int PriorityTracker::level(uint8_t priority)
+{
+    return (priority < LEVELS) ? priority : LEVELS - 1;
+}
+
+// Make bit `level` of `bitmap` say whether `count` is non-zero. Re-checks
+// the count after publishing, so racing updaters always settle on the truth.
+void PriorityTracker::syncBit(std::atomic<uint32_t>& bitmap, std::atomic<uint32_t>& count, int level)
+{
+    uint32_t bit = 1u << level;
+    while (true)
+    {
+        uint32_t n = count.load();
+        uint32_t bits = bitmap.load();
+        uint32_t wanted = (n > 0) ? (bits | bit) : (bits & ~bit);
+        if (wanted == bits || bitmap.compare_exchange_weak(bits, wanted))
+        {
+            if (count.load() == n)
+            {
+                return;
+            }
+        }
+    }
+}
+
+void PriorityTracker::readyAdded(uint8_t priority)
+{
+    int l = level(priority);
+    if (ready_count[l]++ == 0)
+    {
+        syncBit(ready_bitmap, ready_count[l], l);
+    }
+}
+
+void PriorityTracker::readyRemoved(uint8_t priority)
+{
+    int l = level(priority);
+    if (--ready_count[l] == 0)
+    {
+        syncBit(ready_bitmap, ready_count[l], l);
+    }
+}
+
+void PriorityTracker::runningStarted(uint16_t core_id, uint8_t priority)
+{
+    int l = level(priority);
+    running_cores[l * core_words + core_id / 64] |= (uint64_t)1 << (core_id % 64);
+    core_priority[core_id] = l;
+    num_running++;
+    if (running_count[l]++ == 0)
+    {
+        syncBit(running_bitmap, running_count[l], l);
+    }
+}
+
+void PriorityTracker::runningStopped(uint16_t core_id)
+{
+    int16_t l = core_priority[core_id].exchange(IDLE);
+    if (l >= 0)
+    {
+        removeRunning(core_id, l);
+    }
+}
+
+void PriorityTracker::removeRunning(uint16_t core_id, int level)
+{
+    running_cores[level * core_words + core_id / 64] &= ~((uint64_t)1 << (core_id % 64));
+    num_running--;
+    if (--running_count[level] == 0)
+    {
+        syncBit(running_bitmap, running_count[level], level);
+    }
+}
+
+// Highest priority level with a ready process (-1 if none)
+int PriorityTracker::highestReady() const
+{
+    uint32_t bits = ready_bitmap.load();
+    return (bits == 0) ? -1 : 31 - __builtin_clz(bits);
+}
+
+// Lowest priority level running on a core that isn't already being preempted (-1 if none)
+int PriorityTracker::lowestRunning() const
+{
+    uint32_t bits = running_bitmap.load();
+    return (bits == 0) ? -1 : __builtin_ctz(bits);
+}
+
+// Pick the cores to interrupt so the highest priority ready processes get a
+// core: idle (or already preempting) cores absorb the best ready processes
+// first, then each remaining one that outranks the lowest-priority running
+// process takes that process's core. Chosen cores are marked as preempting.
+void PriorityTracker::selectVictims(std::vector<uint16_t>& victims)
+{
+    int i;
+    uint32_t ready[LEVELS];
+    uint32_t bits = ready_bitmap.load();
+    for (i = 0; i < LEVELS; i++)
+    {
+        ready[i] = (bits & (1u << i)) ? ready_count[i].load() : 0;
+    }
+    uint32_t running = num_running.load();
+    uint32_t free_cores = (running < num_cores) ? num_cores - running : 0;
+
+    int hi = LEVELS - 1;
+    while (true)
+    {
+        while (hi >= 0 && ready[hi] == 0)
+        {
+            hi--;
+        }
+        if (hi < 0)
+        {
+            break;
+        }
+        if (free_cores >= ready[hi])
+        {
+            free_cores -= ready[hi];
+            ready[hi] = 0;
+            continue;
+        }
+        ready[hi] -= free_cores;
+        free_cores = 0;
+
+        int lo = lowestRunning();
+        if (lo < 0 || lo >= hi)
+        {
+            break;
+        }
+        int16_t core = -1;
+        for (i = 0; i < (int)core_words && core < 0; i++)
+        {
+            uint64_t word = running_cores[lo * core_words + i].load();
+            if (word != 0)
+            {
+                core = i * 64 + __builtin_ctzll(word);
+            }
+        }
+        int16_t expected = lo;
+        if (core < 0 || !core_priority[core].compare_exchange_strong(expected, PREEMPTING))
+        {
+            // the core stopped running in the meantime: look again
+            continue;
+        }
+        removeRunning(core, lo);
+        victims.push_back(core);
+        ready[hi]--;
+    }
+}
@@ -1,3 +1,4 @@
+#include <thread>
 #include "process.h"
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
@@ -10,25 +11,33 @@ Process::Process(ProcessDetails details, uint64_t current_time)
     start_time = details.start_time;
     num_bursts = details.num_bursts;
     current_burst = 0;
-    burst_times = new uint32_t[num_bursts];
-    for (i = 0; i < num_bursts; i++)
-    {
-        burst_times[i] = details.burst_times[i];
-    }
+    burst_times = details.burst_times;  // not copied: the ProcessTable owns the storage
     priority = details.priority;
+    level = 0;
+    vruntime = 0;
     state = (start_time == 0) ? State::Ready : State::NotStarted;
     lastState = state;
+    launch_time = 0;
     if (state == State::Ready)
     {
         launch_time = current_time;
     }
+    burst_start_time = current_time;
+    state_start = current_time;
+    last_update = current_time;
 
     is_interrupted = false;
     core = -1;
+    last_core = -1;
+    migrations = 0;
+    speed = BASE_CORE_SPEED;
+    run_queue = -1;
     turn_time = 0;
     wait_time = 0;
     cpu_time = 0;
     remain_time = 0;
+    response_time = -1;
+    snapshot_seq = 0;
     for (i = 0; i < num_bursts; i+=2)
     {
         remain_time += burst_times[i];
@@ -37,10 +46,9 @@ Process::Process(ProcessDetails details, uint64_t current_time)
 
 Process::~Process()
 {
-    delete[] burst_times;
 }
 
-uint16_t Process::getPid() const
+uint32_t Process::getPid() const
 {
     return pid;
 }
@@ -50,6 +58,11 @@ uint64_t Process::getLaunchTime() const
     return launch_time;
 }
 
+uint64_t Process::getStateStart() const
+{
+    return state_start;
+}
+
 
 uint32_t Process::getStartTime() const
 {
@@ -61,6 +74,16 @@ uint8_t Process::getPriority() const
     return priority;
 }
 
+uint8_t Process::getLevel() const
+{
+    return level;
+}
+
+uint64_t Process::getVruntime() const
+{
+    return vruntime;
+}
+
 uint16_t Process::get_current_burst_id() const
 {
     return current_burst;
@@ -91,11 +114,21 @@ bool Process::isInterrupted() const
     return is_interrupted;
 }
 
-int8_t Process::getCpuCore() const
+int16_t Process::getCpuCore() const
 {
     return core;
 }
 
+int16_t Process::getLastCore() const
+{
+    return last_core;
+}
+
+uint16_t Process::getMigrations() const
+{
+    return migrations;
+}
+
 double Process::getTurnaroundTime() const
 {
     return (double)turn_time / 1000.0;
@@ -116,6 +149,22 @@ double Process::getRemainingTime() const
     return (double)remain_time / 1000.0;
 }
 
+double Process::getResponseTime() const
+{
+    return (response_time < 0) ? 0.0 : (double)response_time / 1000.0;
+}
+
+// whether the process has been dispatched to a core at least once
+bool Process::hasRun() const
+{
+    return response_time >= 0;
+}
+
+int16_t Process::getRunQueue() const
+{
+    return run_queue.load(std::memory_order_acquire);
+}
+
 void Process::setBurstStartTime(uint64_t current_time)
 {
     burst_start_time = current_time;
@@ -123,11 +172,27 @@ void Process::setBurstStartTime(uint64_t current_time)
 
 void Process::setState(State new_state, uint64_t current_time)
 {
+    beginPublish();
+    // bring statistics up to date for the time spent in the old state
+    accumulate(current_time);
     if (state == State::NotStarted && new_state == State::Ready)
     {
         launch_time = current_time;
+        last_update = current_time;
+    }
+    if (new_state == State::Terminated)
+    {
+        turn_time = current_time - launch_time;
+        remain_time = 0;
     }
+    if (new_state == State::Running && response_time < 0)
+    {
+        response_time = current_time - launch_time;
+    }
+    lastState = state;
     state = new_state;
+    state_start = current_time;
+    endPublish();
 }
 
 
@@ -142,9 +207,43 @@ bool Process::isLastBurst() const{
     return false;
 }
 
-void Process::setCpuCore(int8_t core_num)
+// Taking a core (core_num >= 0) other than the last one counts as a migration
+void Process::setCpuCore(int16_t core_num)
 {
+    beginPublish();
     core = core_num;
+    endPublish();
+    if (core_num >= 0)
+    {
+        if (last_core >= 0 && last_core != core_num)
+        {
+            migrations++;
+        }
+        last_core = core_num;
+    }
+}
+
+// Speed of the core it is about to run on (set before it goes Running)
+void Process::setCoreSpeed(uint16_t core_speed)
+{
+    beginPublish();
+    speed = core_speed;
+    endPublish();
+}
+
+void Process::setLevel(uint8_t new_level)
+{
+    level = new_level;
+}
+
+void Process::setVruntime(uint64_t new_vruntime)
+{
+    vruntime = new_vruntime;
+}
+
+void Process::setRunQueue(int16_t queue)
+{
+    run_queue.store(queue, std::memory_order_release);
 }
 
 void Process::setLastState(State state, uint64_t current_time)
@@ -166,31 +265,96 @@ void Process::updateProcess(uint64_t current_time)
 {
     // use `current_time` to update turnaround time, wait time, burst times, 
     // cpu time, and remaining time
-    if(state != Terminated && ((state == Ready) || (state == Running) || (state == IO) )){
-        turn_time = current_time - launch_time;
+    beginPublish();
+    accumulate(current_time);
+    endPublish();
+}
+
+// statistics are accumulated incrementally since the last update, so this
+// works both when called every tick and only at state transitions
+void Process::accumulate(uint64_t current_time)
+{
+    if (current_time <= last_update || state == NotStarted || state == Terminated)
+    {
+        return;
+    }
+
+    int32_t delta = current_time - last_update;
+    if (state == Ready)
+    {
+        wait_time += delta;
+    }
+    else if (state == Running)
+    {
+        int32_t work = (int64_t)delta * speed / BASE_CORE_SPEED;
+        cpu_time += delta;
+        remain_time = (remain_time > work) ? remain_time - work : 0;
     }
-    //printf("%" PRIu32 "\n", turn_time);
+    turn_time = current_time - launch_time;
+    last_update = current_time;
+}
 
+// Seqlock writer side: only the process's owner calls these (see
+// runqueues.h), so a plain load/store of the sequence number is enough
+void Process::beginPublish()
+{
+    snapshot_seq.store(snapshot_seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
 
+void Process::endPublish()
+{
+    snapshot_seq.store(snapshot_seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
 
-    //updateBurstTime(current_burst, current_time - burst_start_time); 
-    
-    if(state == Running){
-        printf("ct is %ld\n",current_time);
-        printf("ss is %ld\n", state_start);
-        cpu_time = cpu_time + (current_time-state_start); 
-            //printf("%" PRIu32 "\n", cpu_time);
+// Consistent copy of the display fields, taken without any lock: retries
+// while the owner is part way through an update. Times are extrapolated to
+// `current_time` the same way updateProcess() would, but nothing is written.
+Process::Snapshot Process::snapshot(uint64_t current_time) const
+{
+    Snapshot snap;
+    uint64_t updated, launched;
+    uint16_t core_speed;
+    while (true)
+    {
+        uint32_t seq = snapshot_seq.load(std::memory_order_acquire);
+        if (seq & 1)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        snap.state = state;
+        snap.core = core;
+        snap.turn_time = turn_time;
+        snap.wait_time = wait_time;
+        snap.cpu_time = cpu_time;
+        snap.remain_time = remain_time;
+        updated = last_update;
+        launched = launch_time;
+        core_speed = speed;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (snapshot_seq.load(std::memory_order_relaxed) == seq)
+        {
+            break;
+        }
     }
-    else{
-    
-        wait_time = turn_time - cpu_time; 
-    }   
-    
-    
-    remain_time = remain_time - cpu_time; //wrong
-
-    //printf("%" PRIu32 "\n", remain_time);
 
+    if (current_time > updated && snap.state != NotStarted && snap.state != Terminated)
+    {
+        int32_t delta = current_time - updated;
+        if (snap.state == Ready)
+        {
+            snap.wait_time += delta;
+        }
+        else if (snap.state == Running)
+        {
+            int32_t work = (int64_t)delta * core_speed / BASE_CORE_SPEED;
+            snap.cpu_time += delta;
+            snap.remain_time = (snap.remain_time > work) ? snap.remain_time - work : 0;
+        }
+        snap.turn_time = current_time - launched;
+    }
+    return snap;
 }
 
 void Process::updateBurstTime(int burst_idx, uint32_t new_time)
@@ -205,24 +369,19 @@ void Process::incrementBurstIdx()
 }
 
 
-// Comparator methods: used in std::list sort() method
-// No comparator needed for FCFS or RR (ready queue never sorted)
+// Comparator methods: ordering policies for the ready queue heap
+// No comparator needed for FCFS or RR (ready queue is a plain FIFO)
 
-// SJF - comparator for sorting ready queue based on shortest remaining CPU time
+// SJF - comparator for ordering ready queue based on shortest remaining CPU time
 //This will return true if p1 is the faster job and false if p2 is the faster job.
-bool SjfComparator::operator ()(const Process *p1, const Process *p2)
+bool SjfComparator::operator ()(const Process *p1, const Process *p2) const
 {
-    // your code here!
-    if (p1->getRemainingTime() > p2->getRemainingTime()){
-        return false;
-
-    }
-    return true; // change this!
+    return p1->getRemainingTime() < p2->getRemainingTime();
 }
 
-// PP - comparator for sorting read queue based on priority
-bool PpComparator::operator ()(const Process *p1, const Process *p2){
-
+// PP - comparator for ordering ready queue based on priority
+bool PpComparator::operator ()(const Process *p1, const Process *p2) const
+{
     if(p1->getPriority()> p2->getPriority()){
 
         return true;
@@ -0,0 +1,94 @@
+#include <new>
+#include <sys/mman.h>
+#include "processtable.h"
+
+// ProcessTable class methods
+// With TakeBursts the config's burst arena (or its workload mapping) is moved
+// into the table and the config is left without burst times, so deleteConfig
+// won't free them. With CopyBursts (or when every process owns its own array,
+// as from readConfigFile) the bursts are copied and the config is untouched,
+// so several tables can be built from one shared workload.
+ProcessTable::ProcessTable(SchedulerConfig *config, uint64_t current_time, BurstOwnership ownership)
+{
+    size_t i;
+    int j;
+    count = config->num_processes;
+    num_bursts = 0;
+    for (i = 0; i < count; i++)
+    {
+        num_bursts += config->processes[i].num_bursts;
+    }
+
+    bool take = (ownership == TakeBursts && (config->burst_storage != NULL || config->mapping != NULL));
+    uint32_t *copy = NULL;
+    if (take)
+    {
+        burst_storage = config->burst_storage;
+        mapping = config->mapping;
+        mapping_size = config->mapping_size;
+    }
+    else
+    {
+        burst_storage = new uint32_t[num_bursts];
+        mapping = NULL;
+        mapping_size = 0;
+        copy = burst_storage;
+    }
+
+    // priorities are only meaningful to PP and CFS (as weights)
+    bool keep_priority = (config->algorithm == ScheduleAlgorithm::PP || config->algorithm == ScheduleAlgorithm::CFS);
+    processes = static_cast<Process*>(::operator new(count * sizeof(Process)));
+    for (i = 0; i < count; i++)
+    {
+        ProcessDetails slice = config->processes[i];
+        if (!keep_priority)
+        {
+            slice.priority = 0;
+        }
+        if (take)
+        {
+            config->processes[i].burst_times = NULL;
+        }
+        else
+        {
+            for (j = 0; j < slice.num_bursts; j++)
+            {
+                copy[j] = slice.burst_times[j];
+            }
+            slice.burst_times = copy;
+            copy += slice.num_bursts;
+        }
+        new (&processes[i]) Process(slice, current_time);
+    }
+    if (take)
+    {
+        config->burst_storage = NULL;
+        config->mapping = NULL;
+        config->mapping_size = 0;
+    }
+}
+
+ProcessTable::~ProcessTable()
+{
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        processes[i].~Process();
+    }
+    ::operator delete(processes);
+    delete[] burst_storage;
+    if (mapping != NULL)
+    {
+        munmap(mapping, mapping_size);
+    }
+}
+
+size_t ProcessTable::processBytes() const
+{
+    return count * sizeof(Process);
+}
+
+size_t ProcessTable::burstBytes() const
+{
+    return num_bursts * sizeof(uint32_t);
+}
@@ -0,0 +1,210 @@
+#include "profile.h"
+
+#ifdef SCHED_PROFILE
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include "histogram.h"
+
+namespace {
+
+typedef struct SiteStats {
+    uint64_t acquisitions;
+    uint64_t contended;
+    LatencyHistogram wait_ns;
+    LatencyHistogram hold_ns;
+} SiteStats;
+
+// One per thread that takes a profiled lock, indexed by LockSite::id (each
+// site's stats are allocated the first time the thread uses that site)
+typedef struct ThreadStats {
+    std::vector<SiteStats*> sites;
+} ThreadStats;
+
+// One per simulated core: only the thread stepping the core writes it
+typedef struct CoreTime {
+    Profile::Activity activity;
+    uint64_t since;                 // ms, when the current activity began
+    uint64_t ms[Profile::Stopped];  // per activity
+    uint64_t lock_wait_ns;
+} CoreTime;
+
+std::mutex registry_mutex;
+std::vector<std::string> site_names;
+std::vector<ThreadStats*> threads;
+CoreTime *cores = NULL;
+uint16_t profiled_cores = 0;
+std::atomic<bool> profiling(false);
+thread_local ThreadStats *local = NULL;
+thread_local int32_t current_core = -1;
+
+// Same clock (ms since the epoch) as the monitor's currentTime()
+uint64_t clockMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+           std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+SiteStats* siteStats(const LockSite *site)
+{
+    if (local == NULL)
+    {
+        local = new ThreadStats();
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        threads.push_back(local);
+    }
+    if (site->id >= local->sites.size())
+    {
+        local->sites.resize(site->id + 1, NULL);
+    }
+    if (local->sites[site->id] == NULL)
+    {
+        SiteStats *stats = new SiteStats();
+        stats->acquisitions = 0;
+        stats->contended = 0;
+        local->sites[site->id] = stats;
+    }
+    return local->sites[site->id];
+}
+
+double percentOf(uint64_t part, uint64_t whole)
+{
+    return (whole > 0) ? 100.0 * part / whole : 0.0;
+}
+
+} // namespace
+
+void Profile::enable(uint16_t num_cores)
+{
+    uint16_t i;
+    uint64_t now = clockMs();
+    profiled_cores = num_cores;
+    cores = new CoreTime[num_cores];
+    for (i = 0; i < num_cores; i++)
+    {
+        cores[i].activity = Idle;
+        cores[i].since = now;
+        cores[i].ms[Running] = 0;
+        cores[i].ms[Idle] = 0;
+        cores[i].ms[Switching] = 0;
+        cores[i].lock_wait_ns = 0;
+    }
+    profiling = true;
+}
+
+bool Profile::enabled()
+{
+    return profiling.load(std::memory_order_relaxed);
+}
+
+uint32_t Profile::registerSite(const char *name)
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    site_names.push_back(name);
+    return site_names.size() - 1;
+}
+
+uint64_t Profile::clockNanos()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profile::acquired(const LockSite *site, uint64_t wait_ns, bool contended)
+{
+    SiteStats *stats = siteStats(site);
+    stats->acquisitions++;
+    stats->contended += contended ? 1 : 0;
+    stats->wait_ns.record(wait_ns);
+    if (current_core >= 0)
+    {
+        cores[current_core].lock_wait_ns += wait_ns;
+    }
+}
+
+void Profile::released(const LockSite *site, uint64_t hold_ns)
+{
+    siteStats(site)->hold_ns.record(hold_ns);
+}
+
+void Profile::setCurrentCore(int32_t core_id)
+{
+    current_core = profiling ? core_id : -1;
+}
+
+void Profile::activity(uint16_t core_id, Activity activity, uint64_t now)
+{
+    if (!profiling)
+    {
+        return;
+    }
+    CoreTime& core = cores[core_id];
+    if (core.activity != Stopped && now > core.since)
+    {
+        core.ms[core.activity] += now - core.since;
+    }
+    core.activity = activity;
+    core.since = now;
+}
+
+// Sites in registration order, with every thread's stats merged; times in us
+void Profile::print(FILE *out)
+{
+    size_t s, t;
+    uint16_t i;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    fprintf(out, "Lock profile (us)          acquired  contended   wait mean    wait p99    wait max   hold mean    hold p99    hold max\n");
+    for (s = 0; s < site_names.size(); s++)
+    {
+        SiteStats merged;
+        merged.acquisitions = 0;
+        merged.contended = 0;
+        for (t = 0; t < threads.size(); t++)
+        {
+            if (s < threads[t]->sites.size() && threads[t]->sites[s] != NULL)
+            {
+                const SiteStats *stats = threads[t]->sites[s];
+                merged.acquisitions += stats->acquisitions;
+                merged.contended += stats->contended;
+                merged.wait_ns.merge(stats->wait_ns);
+                merged.hold_ns.merge(stats->hold_ns);
+            }
+        }
+        if (merged.acquisitions == 0)
+        {
+            continue;
+        }
+        fprintf(out, "  %-22s %10" PRIu64 " %9.2f%% %11.2f %11.2f %11.2f %11.2f %11.2f %11.2f\n", site_names[s].c_str(),
+                merged.acquisitions, percentOf(merged.contended, merged.acquisitions),
+                merged.wait_ns.mean() / 1000.0, merged.wait_ns.percentile(99.0) / 1000.0, merged.wait_ns.max() / 1000.0,
+                merged.hold_ns.mean() / 1000.0, merged.hold_ns.percentile(99.0) / 1000.0, merged.hold_ns.max() / 1000.0);
+    }
+
+    // lock waits happen inside the other three, so they are listed apart
+    CoreTime all;
+    all.ms[Running] = 0;
+    all.ms[Idle] = 0;
+    all.ms[Switching] = 0;
+    all.lock_wait_ns = 0;
+    fprintf(out, "Core time        running      idle  switching  lock wait (ms)\n");
+    for (i = 0; i < profiled_cores; i++)
+    {
+        const CoreTime& core = cores[i];
+        uint64_t total = core.ms[Running] + core.ms[Idle] + core.ms[Switching];
+        fprintf(out, "  core %-6u %9.1f%% %8.1f%% %9.1f%% %15.2f\n", i, percentOf(core.ms[Running], total),
+                percentOf(core.ms[Idle], total), percentOf(core.ms[Switching], total), core.lock_wait_ns / 1e6);
+        all.ms[Running] += core.ms[Running];
+        all.ms[Idle] += core.ms[Idle];
+        all.ms[Switching] += core.ms[Switching];
+        all.lock_wait_ns += core.lock_wait_ns;
+    }
+    uint64_t total = all.ms[Running] + all.ms[Idle] + all.ms[Switching];
+    fprintf(out, "  all         %9.1f%% %8.1f%% %9.1f%% %15.2f\n", percentOf(all.ms[Running], total),
+            percentOf(all.ms[Idle], total), percentOf(all.ms[Switching], total), all.lock_wait_ns / 1e6);
+}
+
+#endif // SCHED_PROFILE
@@ -0,0 +1,504 @@
+#include <algorithm>
+#include "policy.h"
+#include "readyqueue.h"
+
+// FifoReadyQueue methods
+void FifoReadyQueue::push(Process *p)
+{
+    queue.push_back(p);
+}
+
+Process* FifoReadyQueue::pop()
+{
+    if (queue.empty())
+    {
+        return NULL;
+    }
+    Process *p = queue.front();
+    queue.pop_front();
+    return p;
+}
+
+Process* FifoReadyQueue::front() const
+{
+    return queue.empty() ? NULL : queue.front();
+}
+
+bool FifoReadyQueue::empty() const
+{
+    return queue.empty();
+}
+
+size_t FifoReadyQueue::size() const
+{
+    return queue.size();
+}
+
+
+// MlfqReadyQueue methods
+MlfqReadyQueue::MlfqReadyQueue()
+{
+    bitmap = 0;
+    count = 0;
+}
+
+void MlfqReadyQueue::push(Process *p)
+{
+    int level = std::min<int>(p->getLevel(), LEVELS - 1);
+    levels[level].push_back(p);
+    bitmap |= 1u << level;
+    count++;
+}
+
+Process* MlfqReadyQueue::pop()
+{
+    if (bitmap == 0)
+    {
+        return NULL;
+    }
+    int level = __builtin_ctz(bitmap);
+    Process *p = levels[level].front();
+    levels[level].pop_front();
+    if (levels[level].empty())
+    {
+        bitmap &= ~(1u << level);
+    }
+    count--;
+    return p;
+}
+
+Process* MlfqReadyQueue::front() const
+{
+    return (bitmap == 0) ? NULL : levels[__builtin_ctz(bitmap)].front();
+}
+
+bool MlfqReadyQueue::empty() const
+{
+    return count == 0;
+}
+
+size_t MlfqReadyQueue::size() const
+{
+    return count;
+}
+
+// Everything goes to the back of level 0, higher levels first, so the
+// existing order is kept
+void MlfqReadyQueue::boost()
+{
+    int level;
+    for (level = 1; level < LEVELS; level++)
+    {
+        while (!levels[level].empty())
+        {
+            Process *p = levels[level].front();
+            levels[level].pop_front();
+            p->setLevel(0);
+            levels[0].push_back(p);
+        }
+    }
+    bitmap = (count > 0) ? 1 : 0;
+}
+
+
+// CfsReadyQueue methods (red-black tree as in CLRS, with node indices for
+// pointers and node 0 as the sentinel leaf)
+CfsReadyQueue::CfsReadyQueue()
+{
+    Node nil;
+    nil.process = NULL;
+    nil.key = 0;
+    nil.seq = 0;
+    nil.parent = nil.left = nil.right = NIL;
+    nil.red = false;
+    nodes.push_back(nil);
+    root = NIL;
+    leftmost = NIL;
+    count = 0;
+    next_seq = 0;
+    min_vruntime = 0;
+}
+
+bool CfsReadyQueue::before(uint32_t n1, uint32_t n2) const
+{
+    if (nodes[n1].key != nodes[n2].key)
+    {
+        return nodes[n1].key < nodes[n2].key;
+    }
+    return nodes[n1].seq < nodes[n2].seq;
+}
+
+void CfsReadyQueue::rotateLeft(uint32_t x)
+{
+    uint32_t y = nodes[x].right;
+    nodes[x].right = nodes[y].left;
+    if (nodes[y].left != NIL)
+    {
+        nodes[nodes[y].left].parent = x;
+    }
+    nodes[y].parent = nodes[x].parent;
+    if (nodes[x].parent == NIL)
+    {
+        root = y;
+    }
+    else if (x == nodes[nodes[x].parent].left)
+    {
+        nodes[nodes[x].parent].left = y;
+    }
+    else
+    {
+        nodes[nodes[x].parent].right = y;
+    }
+    nodes[y].left = x;
+    nodes[x].parent = y;
+}
+
+void CfsReadyQueue::rotateRight(uint32_t x)
+{
+    uint32_t y = nodes[x].left;
+    nodes[x].left = nodes[y].right;
+    if (nodes[y].right != NIL)
+    {
+        nodes[nodes[y].right].parent = x;
+    }
+    nodes[y].parent = nodes[x].parent;
+    if (nodes[x].parent == NIL)
+    {
+        root = y;
+    }
+    else if (x == nodes[nodes[x].parent].right)
+    {
+        nodes[nodes[x].parent].right = y;
+    }
+    else
+    {
+        nodes[nodes[x].parent].left = y;
+    }
+    nodes[y].right = x;
+    nodes[x].parent = y;
+}
+
+void CfsReadyQueue::insertFixup(uint32_t z)
+{
+    while (nodes[nodes[z].parent].red)
+    {
+        uint32_t parent = nodes[z].parent;
+        uint32_t grandparent = nodes[parent].parent;
+        if (parent == nodes[grandparent].left)
+        {
+            uint32_t uncle = nodes[grandparent].right;
+            if (nodes[uncle].red)
+            {
+                nodes[parent].red = false;
+                nodes[uncle].red = false;
+                nodes[grandparent].red = true;
+                z = grandparent;
+            }
+            else
+            {
+                if (z == nodes[parent].right)
+                {
+                    z = parent;
+                    rotateLeft(z);
+                    parent = nodes[z].parent;
+                }
+                nodes[parent].red = false;
+                nodes[grandparent].red = true;
+                rotateRight(grandparent);
+            }
+        }
+        else
+        {
+            uint32_t uncle = nodes[grandparent].left;
+            if (nodes[uncle].red)
+            {
+                nodes[parent].red = false;
+                nodes[uncle].red = false;
+                nodes[grandparent].red = true;
+                z = grandparent;
+            }
+            else
+            {
+                if (z == nodes[parent].left)
+                {
+                    z = parent;
+                    rotateRight(z);
+                    parent = nodes[z].parent;
+                }
+                nodes[parent].red = false;
+                nodes[grandparent].red = true;
+                rotateLeft(grandparent);
+            }
+        }
+    }
+    nodes[root].red = false;
+}
+
+// Put subtree v where subtree u was (v's parent is set even if v is the
+// sentinel, which eraseFixup relies on)
+void CfsReadyQueue::transplant(uint32_t u, uint32_t v)
+{
+    if (nodes[u].parent == NIL)
+    {
+        root = v;
+    }
+    else if (u == nodes[nodes[u].parent].left)
+    {
+        nodes[nodes[u].parent].left = v;
+    }
+    else
+    {
+        nodes[nodes[u].parent].right = v;
+    }
+    nodes[v].parent = nodes[u].parent;
+}
+
+void CfsReadyQueue::eraseFixup(uint32_t x)
+{
+    while (x != root && !nodes[x].red)
+    {
+        uint32_t parent = nodes[x].parent;
+        if (x == nodes[parent].left)
+        {
+            uint32_t w = nodes[parent].right;
+            if (nodes[w].red)
+            {
+                nodes[w].red = false;
+                nodes[parent].red = true;
+                rotateLeft(parent);
+                w = nodes[parent].right;
+            }
+            if (!nodes[nodes[w].left].red && !nodes[nodes[w].right].red)
+            {
+                nodes[w].red = true;
+                x = parent;
+            }
+            else
+            {
+                if (!nodes[nodes[w].right].red)
+                {
+                    nodes[nodes[w].left].red = false;
+                    nodes[w].red = true;
+                    rotateRight(w);
+                    w = nodes[parent].right;
+                }
+                nodes[w].red = nodes[parent].red;
+                nodes[parent].red = false;
+                nodes[nodes[w].right].red = false;
+                rotateLeft(parent);
+                x = root;
+            }
+        }
+        else
+        {
+            uint32_t w = nodes[parent].left;
+            if (nodes[w].red)
+            {
+                nodes[w].red = false;
+                nodes[parent].red = true;
+                rotateRight(parent);
+                w = nodes[parent].left;
+            }
+            if (!nodes[nodes[w].right].red && !nodes[nodes[w].left].red)
+            {
+                nodes[w].red = true;
+                x = parent;
+            }
+            else
+            {
+                if (!nodes[nodes[w].left].red)
+                {
+                    nodes[nodes[w].right].red = false;
+                    nodes[w].red = true;
+                    rotateLeft(w);
+                    w = nodes[parent].left;
+                }
+                nodes[w].red = nodes[parent].red;
+                nodes[parent].red = false;
+                nodes[nodes[w].left].red = false;
+                rotateRight(parent);
+                x = root;
+            }
+        }
+    }
+    nodes[x].red = false;
+}
+
+uint32_t CfsReadyQueue::minimum(uint32_t x) const
+{
+    while (nodes[x].left != NIL)
+    {
+        x = nodes[x].left;
+    }
+    return x;
+}
+
+void CfsReadyQueue::erase(uint32_t z)
+{
+    uint32_t x;
+    uint32_t y = z;
+    bool y_was_red = nodes[y].red;
+    if (z == leftmost)
+    {
+        // the successor of the leftmost node: its right subtree's minimum, or
+        // else its parent
+        leftmost = (nodes[z].right != NIL) ? minimum(nodes[z].right) : nodes[z].parent;
+    }
+    if (nodes[z].left == NIL)
+    {
+        x = nodes[z].right;
+        transplant(z, x);
+    }
+    else if (nodes[z].right == NIL)
+    {
+        x = nodes[z].left;
+        transplant(z, x);
+    }
+    else
+    {
+        y = minimum(nodes[z].right);
+        y_was_red = nodes[y].red;
+        x = nodes[y].right;
+        if (nodes[y].parent == z)
+        {
+            nodes[x].parent = y;
+        }
+        else
+        {
+            transplant(y, x);
+            nodes[y].right = nodes[z].right;
+            nodes[nodes[y].right].parent = y;
+        }
+        transplant(z, y);
+        nodes[y].left = nodes[z].left;
+        nodes[nodes[y].left].parent = y;
+        nodes[y].red = nodes[z].red;
+    }
+    if (!y_was_red)
+    {
+        eraseFixup(x);
+    }
+    nodes[NIL].parent = NIL;
+
+    nodes[z].process = NULL;
+    free_nodes.push_back(z);
+    count--;
+}
+
+void CfsReadyQueue::push(Process *p)
+{
+    if (p->getVruntime() < min_vruntime)
+    {
+        p->setVruntime(min_vruntime);
+    }
+
+    uint32_t z;
+    if (free_nodes.empty())
+    {
+        z = nodes.size();
+        nodes.push_back(Node());
+    }
+    else
+    {
+        z = free_nodes.back();
+        free_nodes.pop_back();
+    }
+    nodes[z].process = p;
+    nodes[z].key = p->getVruntime();
+    nodes[z].seq = next_seq++;
+    nodes[z].left = nodes[z].right = NIL;
+    nodes[z].red = true;
+
+    uint32_t parent = NIL;
+    uint32_t x = root;
+    bool leftmost_path = true;
+    while (x != NIL)
+    {
+        parent = x;
+        if (before(z, x))
+        {
+            x = nodes[x].left;
+        }
+        else
+        {
+            x = nodes[x].right;
+            leftmost_path = false;
+        }
+    }
+    nodes[z].parent = parent;
+    if (parent == NIL)
+    {
+        root = z;
+    }
+    else if (before(z, parent))
+    {
+        nodes[parent].left = z;
+    }
+    else
+    {
+        nodes[parent].right = z;
+    }
+    if (leftmost_path)
+    {
+        leftmost = z;
+    }
+    count++;
+    insertFixup(z);
+}
+
+Process* CfsReadyQueue::pop()
+{
+    if (leftmost == NIL)
+    {
+        return NULL;
+    }
+    Process *p = nodes[leftmost].process;
+    if (nodes[leftmost].key > min_vruntime)
+    {
+        min_vruntime = nodes[leftmost].key;
+    }
+    erase(leftmost);
+    return p;
+}
+
+Process* CfsReadyQueue::front() const
+{
+    return (leftmost == NIL) ? NULL : nodes[leftmost].process;
+}
+
+bool CfsReadyQueue::empty() const
+{
+    return count == 0;
+}
+
+size_t CfsReadyQueue::size() const
+{
+    return count;
+}
+
+uint64_t CfsReadyQueue::minVruntime() const
+{
+    return min_vruntime;
+}
+
+
+namespace {
+
+typedef struct QueueFactory {
+    ReadyQueue *queue;
+
+    template <typename Policy>
+    void run()
+    {
+        queue = new typename Policy::Queue();
+    }
+} QueueFactory;
+
+} // namespace
+
+ReadyQueue* createReadyQueue(ScheduleAlgorithm algorithm)
+{
+    QueueFactory factory;
+    withPolicy(algorithm, factory);
+    return factory.queue;
+}
@@ -0,0 +1,595 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include "runqueues.h"
+
+namespace {
+
+// enqueueBatch(): group the placed processes by queue, keeping their order
+struct QueueOrder {
+    bool operator ()(const std::pair<uint16_t, Process*>& a, const std::pair<uint16_t, Process*>& b) const
+    {
+        return a.first < b.first;
+    }
+};
+
+// Same clock (ms since the epoch) as the scheduler threads' currentTime()
+uint64_t clockMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+           std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+// RunQueues class methods
+RunQueues::RunQueues(Mode mode, ScheduleAlgorithm algorithm, uint16_t num_cores, uint32_t affinity_wait)
+{
+    uint16_t i;
+    this->mode = mode;
+    num_queues = (mode == Mode::PerCore && num_cores > 0) ? num_cores : 1;
+    queues = new Queue[num_queues];
+    for (i = 0; i < num_queues; i++)
+    {
+        queues[i].ready = createReadyQueue(algorithm);
+        queues[i].queued = 0;
+        queues[i].load = 0;
+        queues[i].top_priority = -1;
+        queues[i].acquisitions = 0;
+        queues[i].contended = 0;
+        queues[i].blocked_ns = 0;
+    }
+    steals = 0;
+    priorities = (algorithm == ScheduleAlgorithm::PP) ? new PriorityTracker(num_cores) : NULL;
+    this->affinity_wait = affinity_wait;
+    affinity = (mode == Mode::Global && affinity_wait > 0) ? new AffinitySlots(num_cores, affinity_wait) : NULL;
+    speeds = NULL;
+    waker = NULL;
+
+    this->num_cores = num_cores;
+    idle_parked = new bool[num_cores];
+    for (i = 0; i < num_cores; i++)
+    {
+        idle_parked[i] = false;
+    }
+    num_idle = 0;
+    stopping = false;
+}
+
+RunQueues::~RunQueues()
+{
+    uint16_t i;
+    for (i = 0; i < num_queues; i++)
+    {
+        delete queues[i].ready;
+    }
+    delete[] queues;
+    delete[] idle_parked;
+    delete priorities;
+    delete affinity;
+    delete[] speeds;
+}
+
+RunQueues::Mode RunQueues::getMode() const
+{
+    return mode;
+}
+
+// Queue that a core dispatches from (and returns interrupted processes to)
+uint16_t RunQueues::queueOf(uint16_t core_id) const
+{
+    return (mode == Mode::PerCore) ? core_id : 0;
+}
+
+// Lock a queue at `site`, counting how often (and for how long) the lock was
+// already held by someone else
+std::unique_lock<ProfiledMutex> RunQueues::lockQueue(uint16_t queue, const LockSite *site)
+{
+    Queue& q = queues[queue];
+    uint64_t blocked_ns;
+    if (q.mutex.lock(site, &blocked_ns))
+    {
+        q.contended.fetch_add(1, std::memory_order_relaxed);
+        q.blocked_ns.fetch_add(blocked_ns, std::memory_order_relaxed);
+    }
+    q.acquisitions.fetch_add(1, std::memory_order_relaxed);
+    return std::unique_lock<ProfiledMutex>(q.mutex, std::adopt_lock);
+}
+
+// Lock whichever queue currently owns `p` (returns an unlocked lock if the
+// process belongs to the monitor). Retries if the process moved while waiting.
+std::unique_lock<ProfiledMutex> RunQueues::lockProcess(Process *p, const LockSite *site)
+{
+    while (true)
+    {
+        int16_t home = p->getRunQueue();
+        if (home < 0)
+        {
+            return std::unique_lock<ProfiledMutex>();
+        }
+        std::unique_lock<ProfiledMutex> lock = lockQueue(home, site);
+        if (p->getRunQueue() == home)
+        {
+            return lock;
+        }
+    }
+}
+
+// Queue a monitor-owned Ready process should go on: the least-loaded one
+uint16_t RunQueues::placement(const Process *p) const
+{
+    uint16_t i;
+    uint16_t target = 0;
+    uint32_t best = queues[0].load.load(std::memory_order_relaxed);
+    for (i = 1; i < num_queues; i++)
+    {
+        uint32_t load = queues[i].load.load(std::memory_order_relaxed);
+        // by speed: the queue whose core would get through one more process soonest
+        bool better = (speeds != NULL) ? (uint64_t)(load + 1) * speeds[target] < (uint64_t)(best + 1) * speeds[i]
+                                       : load < best;
+        if (better)
+        {
+            best = load;
+            target = i;
+        }
+    }
+    int16_t last = p->getLastCore();
+    if (mode == Mode::PerCore && affinity_wait > 0 && last >= 0 &&
+        queues[last].load.load(std::memory_order_relaxed) <= best + 1)
+    {
+        target = last;
+    }
+    return target;
+}
+
+// Place monitor-owned Ready processes, each on the least-loaded queue at the
+// time, taking each queue's lock once. Loads are raised as the processes are
+// placed, so a batch spreads out over the queues.
+void RunQueues::enqueueBatch(const std::vector<Process*>& batch)
+{
+    size_t i;
+    std::vector<std::pair<uint16_t, Process*> > placed;
+    for (i = 0; i < batch.size(); i++)
+    {
+        uint16_t target = placement(batch[i]);
+        queues[target].load++;
+        placed.push_back(std::make_pair(target, batch[i]));
+    }
+    if (num_queues > 1)
+    {
+        std::stable_sort(placed.begin(), placed.end(), QueueOrder());
+    }
+
+    i = 0;
+    while (i < placed.size())
+    {
+        uint16_t target = placed[i].first;
+        std::unique_lock<ProfiledMutex> lock = lockQueue(target, LOCK_SITE("queue: enqueue batch"));
+        for (; i < placed.size() && placed[i].first == target; i++)
+        {
+            placed[i].second->setRunQueue(target);
+            pushLocked(target, placed[i].second);
+        }
+    }
+}
+
+// Add a process to a queue whose lock the caller already holds
+void RunQueues::pushLocked(uint16_t queue, Process *p)
+{
+    queues[queue].ready->push(p);
+    queues[queue].queued++;
+    if (priorities != NULL)
+    {
+        priorities->readyAdded(p->getPriority());
+        updateTop(queue);
+    }
+    wakeIdle(queue);
+}
+
+// Get the next process for a core: from its own queue if possible, otherwise
+// steal one (PP per core: a better process queued elsewhere comes first). The
+// returned process is owned by the core's queue.
+Process* RunQueues::take(uint16_t core_id)
+{
+    uint16_t own = queueOf(core_id);
+    if (priorities != NULL && mode == Mode::PerCore)
+    {
+        int16_t better = outranking(own);
+        Process *p = (better >= 0) ? stealFrom(better, core_id) : NULL;
+        if (p != NULL)
+        {
+            return p;
+        }
+    }
+    {
+        std::unique_lock<ProfiledMutex> lock = lockQueue(own, LOCK_SITE("queue: take"));
+        Process *p = (affinity != NULL) ? takeAffine(core_id) : popLocked(own);
+        if (p != NULL)
+        {
+            return p;
+        }
+    }
+    if (mode == Mode::PerCore)
+    {
+        return steal(core_id);
+    }
+    return NULL;
+}
+
+// take() for up to `max` processes under one acquisition of the core's own
+// queue lock. The caller runs them in the order given. Only a lone core
+// batches: with more, a reserved process could neither be stolen by an idle
+// core nor keep its place in line against what the others dispatch, so it
+// is a plain take() (as it is with an affinity wait). Returns how many it took.
+uint32_t RunQueues::takeBatch(uint16_t core_id, Process **batch, uint32_t max)
+{
+    if (max <= 1 || affinity != NULL || num_cores > 1)
+    {
+        batch[0] = take(core_id);
+        return (batch[0] != NULL) ? 1 : 0;
+    }
+    uint16_t own = queueOf(core_id);
+    uint32_t count = 0;
+    std::unique_lock<ProfiledMutex> lock = lockQueue(own, LOCK_SITE("queue: take batch"));
+    while (count < max)
+    {
+        Process *p = popLocked(own);
+        if (p == NULL)
+        {
+            break;
+        }
+        batch[count++] = p;
+    }
+    return count;
+}
+
+Process* RunQueues::popLocked(uint16_t queue)
+{
+    Process *p = queues[queue].ready->pop();
+    if (p != NULL)
+    {
+        queues[queue].queued--;
+        if (priorities != NULL)
+        {
+            priorities->readyRemoved(p->getPriority());
+            updateTop(queue);
+        }
+    }
+    return p;
+}
+
+// PP (queue lock held): publish the priority now at the front of the queue
+void RunQueues::updateTop(uint16_t queue)
+{
+    Process *front = queues[queue].ready->front();
+    queues[queue].top_priority.store((front != NULL) ? front->getPriority() : -1, std::memory_order_relaxed);
+}
+
+// PP: the other queue with the best process at its front, if that process
+// outranks the front of `queue` (-1 if none does)
+int16_t RunQueues::outranking(uint16_t queue) const
+{
+    uint16_t i;
+    int16_t best = -1;
+    int16_t top = queues[queue].top_priority.load(std::memory_order_relaxed);
+    for (i = 0; i < num_queues; i++)
+    {
+        int16_t priority = queues[i].top_priority.load(std::memory_order_relaxed);
+        if (i != queue && priority > top)
+        {
+            top = priority;
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Global mode with affinity (queue lock held): a process parked for this core
+// or overdue, otherwise the queue head unless it belongs on another core, in
+// which case it is parked there and that core woken if it is idle
+Process* RunQueues::takeAffine(uint16_t core_id)
+{
+    uint64_t now = clockMs();
+    Process *p = affinity->claim(core_id, now);
+    while (p == NULL)
+    {
+        p = popLocked(0);
+        if (p == NULL)
+        {
+            break;
+        }
+        int16_t last = p->getLastCore();
+        if (last >= 0 && last != core_id && affinity->park(p, now))
+        {
+            // if its core is busy, an idle one has to wake when the wait runs out
+            if (!wakeCore(last))
+            {
+                wakeIdle(0);
+            }
+            p = NULL;
+        }
+    }
+    return p;
+}
+
+// Take the best process from the busiest other queue
+Process* RunQueues::steal(uint16_t core_id)
+{
+    uint16_t i;
+    int16_t victim = -1;
+    uint32_t most = 0;
+    for (i = 0; i < num_queues; i++)
+    {
+        uint32_t queued = queues[i].queued.load(std::memory_order_relaxed);
+        if (i != core_id && queued > most)
+        {
+            most = queued;
+            victim = i;
+        }
+    }
+    if (victim < 0)
+    {
+        return NULL;
+    }
+    return stealFrom(victim, core_id);
+}
+
+// Move the front of queue `victim` to core `core_id`'s queue (NULL if it
+// emptied in the meantime)
+Process* RunQueues::stealFrom(uint16_t victim, uint16_t core_id)
+{
+    std::unique_lock<ProfiledMutex> lock = lockQueue(victim, LOCK_SITE("queue: steal"));
+    Process *p = popLocked(victim);
+    if (p == NULL)
+    {
+        return NULL;
+    }
+    queues[victim].load--;
+    queues[core_id].load++;
+    p->setRunQueue(core_id);
+    steals.fetch_add(1, std::memory_order_relaxed);
+    return p;
+}
+
+// A process left its core for good (I/O or terminated): caller holds the
+// process's queue lock; afterwards the process belongs to the monitor
+void RunQueues::release(Process *p)
+{
+    queues[p->getRunQueue()].load--;
+    p->setRunQueue(-1);
+}
+
+bool RunQueues::hasWork(uint16_t core_id) const
+{
+    uint16_t i;
+    if (queues[queueOf(core_id)].queued > 0)
+    {
+        return true;
+    }
+    if (affinity != NULL && affinity->claimable(core_id, clockMs()))
+    {
+        return true;
+    }
+    for (i = 0; mode == Mode::PerCore && i < num_queues; i++)
+    {
+        if (queues[i].queued > 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Processes competing for a core (queued or running, at least 1): its own
+// queue's load, shared out between the cores that dispatch from it
+uint32_t RunQueues::runnable(uint16_t core_id) const
+{
+    uint32_t sharing = (mode == Mode::PerCore) ? 1 : num_cores;
+    uint32_t load = queues[queueOf(core_id)].load.load(std::memory_order_relaxed);
+    return std::max<uint32_t>((load + sharing - 1) / sharing, 1);
+}
+
+// Announce the core as idle and return true, unless there is work for it
+// after all (or the run is over). The core then waits for its waker, or
+// until parkedUntil(), and calls park() again (or unpark() if it finds work
+// on its own).
+bool RunQueues::park(uint16_t core_id)
+{
+    std::unique_lock<ProfiledMutex> lock = lockAt(idle_mutex, LOCK_SITE("idle: park"));
+    if (stopping)
+    {
+        return false;
+    }
+    if (!idle_parked[core_id])
+    {
+        idle_parked[core_id] = true;
+        num_idle++;
+    }
+    if (hasWork(core_id))
+    {
+        idle_parked[core_id] = false;
+        num_idle--;
+        return false;
+    }
+    return true;
+}
+
+void RunQueues::unpark(uint16_t core_id)
+{
+    std::unique_lock<ProfiledMutex> lock = lockAt(idle_mutex, LOCK_SITE("idle: unpark"));
+    if (idle_parked[core_id])
+    {
+        idle_parked[core_id] = false;
+        num_idle--;
+    }
+}
+
+// When a parked core should look again even if nobody wakes it: the next
+// affinity deadline (UINT64_MAX if none)
+uint64_t RunQueues::parkedUntil() const
+{
+    return (affinity != NULL) ? affinity->nextDeadline() : UINT64_MAX;
+}
+
+void RunQueues::setWaker(CoreWaker *waker)
+{
+    this->waker = waker;
+}
+
+// New work on `queue`: wake its core if parked, otherwise any parked core
+// (which will steal it in per-core mode, or share the queue in global mode)
+void RunQueues::wakeIdle(uint16_t queue)
+{
+    uint16_t i;
+    if (num_idle == 0)
+    {
+        return;
+    }
+    std::unique_lock<ProfiledMutex> lock = lockAt(idle_mutex, LOCK_SITE("idle: wake idle"));
+    int16_t target = -1;
+    if (mode == Mode::PerCore && idle_parked[queue])
+    {
+        target = queue;
+    }
+    // speed placement: the fastest parked core
+    for (i = 0; speeds != NULL && !(mode == Mode::PerCore && target == queue) && i < num_cores; i++)
+    {
+        if (idle_parked[i] && (target < 0 || speeds[i] > speeds[target]))
+        {
+            target = i;
+        }
+    }
+    for (i = 0; target < 0 && i < num_cores; i++)
+    {
+        if (idle_parked[i])
+        {
+            target = i;
+        }
+    }
+    if (target >= 0)
+    {
+        idle_parked[target] = false;
+        num_idle--;
+        waker->wake(target);
+    }
+}
+
+// Wake a specific core if it is parked (false if it is not)
+bool RunQueues::wakeCore(uint16_t core_id)
+{
+    if (num_idle == 0)
+    {
+        return false;
+    }
+    std::unique_lock<ProfiledMutex> lock = lockAt(idle_mutex, LOCK_SITE("idle: wake core"));
+    if (!idle_parked[core_id])
+    {
+        return false;
+    }
+    idle_parked[core_id] = false;
+    num_idle--;
+    waker->wake(core_id);
+    return true;
+}
+
+void RunQueues::wakeAll()
+{
+    uint16_t i;
+    std::unique_lock<ProfiledMutex> lock = lockAt(idle_mutex, LOCK_SITE("idle: wake all"));
+    stopping = true;
+    for (i = 0; i < num_cores; i++)
+    {
+        if (idle_parked[i])
+        {
+            idle_parked[i] = false;
+            waker->wake(i);
+        }
+    }
+    num_idle = 0;
+}
+
+// MLFQ periodic boost of every queued process (see ReadyQueue::boost())
+void RunQueues::boost()
+{
+    uint16_t i;
+    for (i = 0; i < num_queues; i++)
+    {
+        std::unique_lock<ProfiledMutex> lock = lockQueue(i, LOCK_SITE("queue: boost"));
+        queues[i].ready->boost();
+        if (affinity != NULL)
+        {
+            affinity->boost();
+        }
+    }
+}
+
+// Steer work towards the fastest cores (see the class comment)
+void RunQueues::placeBySpeed(const std::vector<CoreUsage>& cores)
+{
+    size_t i;
+    delete[] speeds;
+    speeds = new uint16_t[num_cores];
+    for (i = 0; i < num_cores; i++)
+    {
+        speeds[i] = (i < cores.size()) ? cores[i].speed : BASE_CORE_SPEED;
+    }
+}
+
+PriorityTracker* RunQueues::priorityTracker() const
+{
+    return priorities;
+}
+
+uint64_t RunQueues::lockAcquisitions() const
+{
+    uint16_t i;
+    uint64_t total = 0;
+    for (i = 0; i < num_queues; i++)
+    {
+        total += queues[i].acquisitions.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t RunQueues::contendedAcquisitions() const
+{
+    uint16_t i;
+    uint64_t total = 0;
+    for (i = 0; i < num_queues; i++)
+    {
+        total += queues[i].contended.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+// Total time threads spent waiting for a queue lock someone else held (ns)
+uint64_t RunQueues::blockedNanos() const
+{
+    uint16_t i;
+    uint64_t total = 0;
+    for (i = 0; i < num_queues; i++)
+    {
+        total += queues[i].blocked_ns.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t RunQueues::stealCount() const
+{
+    return steals.load(std::memory_order_relaxed);
+}
+
+
+RunQueues::Mode runQueueModeFromString(const char *name, bool *ok)
+{
+    *ok = true;
+    if (strcmp(name, "global") == 0) return RunQueues::Mode::Global;
+    if (strcmp(name, "percore") == 0) return RunQueues::Mode::PerCore;
+    *ok = false;
+    return RunQueues::Mode::Global;
+}
+
+const char* runQueueModeToString(RunQueues::Mode mode)
+{
+    return (mode == RunQueues::Mode::PerCore) ? "percore" : "global";
+}
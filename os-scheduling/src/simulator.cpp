@@ -0,0 +1,498 @@
+#include <algorithm>
+#include <queue>
+#include <vector>
+#include "affinity.h"
+#include "policy.h"
+#include "prioritytracker.h"
+#include "simulator.h"
+
+namespace {
+
+// Event loop for one scheduling policy. With I/O devices configured, an
+// IoDone is only scheduled once the device starts serving the request.
+template <typename Policy>
+class PolicySimulator : public Simulator::Engine {
+private:
+    enum EventType : uint8_t { Arrival, IoDone, BurstDone, SliceExpired, SwitchDone, MigrationDone, AffinityTimeout };
+
+    typedef struct Event {
+        uint64_t time;      // virtual time (ms) that the event fires
+        uint64_t seq;       // insertion order: keeps events at the same time FIFO
+        EventType type;     // what happened
+        Process *process;   // process the event applies to (Arrival, IoDone, MigrationDone)
+        uint32_t core;      // core the event applies to (BurstDone, SliceExpired, SwitchDone, MigrationDone)
+        uint32_t token;     // core generation when scheduled: stale core events are ignored
+    } Event;
+
+    typedef struct CoreState {
+        Process *running;   // process currently on the core (NULL if none)
+        bool switching;     // core is busy with a context switch (or a migration)
+        uint32_t token;     // bumped whenever the core's pending event is cancelled
+    } CoreState;
+
+    // Event comparator: used by the priority queue so the earliest event is on top
+    struct EventLater {
+        bool operator ()(const Event& e1, const Event& e2) const
+        {
+            if (e1.time != e2.time)
+            {
+                return e1.time > e2.time;
+            }
+            return e1.seq > e2.seq;
+        }
+    };
+
+    Policy policy;
+    uint32_t context_switch;
+    uint32_t migration_penalty;
+    uint32_t affinity_wait;
+    bool speed_placement;
+    ProcessTable& processes;
+    std::vector<CoreState> cores;
+    typename Policy::Queue ready_queue;
+    PriorityTracker *priorities;    // PRIORITY_PREEMPTION only: ready/running priority levels
+    AffinitySlots affinity;         // processes held back for the core they last ran on
+    std::priority_queue<Event, std::vector<Event>, EventLater> events;
+    uint64_t next_seq;
+    uint64_t next_boost;            // PERIODIC_BOOST only: time of the next boost
+
+    void schedule(uint64_t time, EventType type, Process *process, uint32_t core, uint32_t token)
+    {
+        Event event;
+        event.time = time;
+        event.seq = next_seq++;
+        event.type = type;
+        event.process = process;
+        event.core = core;
+        event.token = token;
+        events.push(event);
+    }
+
+    void handleEvent(const Event& event)
+    {
+        Process *p;
+        CoreState *core;
+        switch (event.type)
+        {
+            case EventType::Arrival:
+                p = event.process;
+                p->setState(Process::State::Ready, now);
+                makeReady(p);
+                break;
+            case EventType::IoDone:
+                // I/O burst finished: its device serves the next request, and
+                // the process moves on to its next CPU burst
+                p = event.process;
+                if (io_devices.enabled())
+                {
+                    Process *next = io_devices.deviceOf(p).finish(now);
+                    if (next != NULL)
+                    {
+                        schedule(now + next->getCurrentBurstTime(), EventType::IoDone, next, 0, 0);
+                    }
+                }
+                p->incrementBurstIdx();
+                p->setState(Process::State::Ready, now);
+                makeReady(p);
+                break;
+            case EventType::BurstDone:
+                core = &cores[event.core];
+                if (core->token != event.token)
+                {
+                    break;
+                }
+                p = core->running;
+                policy.ran(p, now - p->getBurstStartTime());
+                if (p->isLastBurst())
+                {
+                    p->setState(Process::State::Terminated, now);
+                    latencies.terminated(p);
+                }
+                else
+                {
+                    policy.blocked(p);
+                    p->incrementBurstIdx();
+                    p->setState(Process::State::IO, now);
+                    p->setBurstStartTime(now);
+                    if (!io_devices.enabled() || io_devices.deviceOf(p).submit(p, now))
+                    {
+                        schedule(now + p->getCurrentBurstTime(), EventType::IoDone, p, 0, 0);
+                    }
+                }
+                removeFromCore(event.core);
+                break;
+            case EventType::SliceExpired:
+                core = &cores[event.core];
+                if (core->token != event.token)
+                {
+                    break;
+                }
+                p = core->running;
+                policy.ran(p, now - p->getBurstStartTime());
+                p->updateBurstTime(p->get_current_burst_id(), workLeft(event.core, p));
+                p->setState(Process::State::Ready, now);
+                removeFromCore(event.core);
+                policy.sliceExpired(p);
+                makeReady(p);
+                break;
+            case EventType::SwitchDone:
+                core = &cores[event.core];
+                if (core->token == event.token)
+                {
+                    core->switching = false;
+                }
+                break;
+            case EventType::MigrationDone:
+                // caches warmed up on the new core: the process can start
+                cores[event.core].switching = false;
+                startRunning(event.core, event.process);
+                break;
+            case EventType::AffinityTimeout:
+                // nothing to do here: a parked process may now go to any core,
+                // which the dispatch after this instant takes care of
+                break;
+        }
+    }
+
+    void makeReady(Process *p)
+    {
+        ready_queue.push(p);
+        if (Policy::PRIORITY_PREEMPTION)
+        {
+            priorities->readyAdded(p->getPriority());
+        }
+    }
+
+    bool coreFree(uint32_t core_id) const
+    {
+        return cores[core_id].running == NULL && !cores[core_id].switching;
+    }
+
+    // Next process for a free core: one parked for it (or whose affinity wait
+    // ran out), else the head of the ready queue. A head that last ran on
+    // another core goes straight there if that core is free too, or is
+    // parked for it if it is busy.
+    void dispatch()
+    {
+        uint32_t i;
+        if (speed_placement)
+        {
+            dispatchBySpeed();
+            return;
+        }
+        for (i = 0; i < cores.size(); i++)
+        {
+            while (coreFree(i))
+            {
+                Process *p = affinity.claim(i, now);
+                if (p == NULL)
+                {
+                    p = ready_queue.pop();
+                    if (p == NULL)
+                    {
+                        break;
+                    }
+                    if (Policy::PRIORITY_PREEMPTION)
+                    {
+                        priorities->readyRemoved(p->getPriority());
+                    }
+                    int16_t last = p->getLastCore();
+                    if (affinity.enabled() && last >= 0 && (uint32_t)last != i)
+                    {
+                        if (coreFree(last))
+                        {
+                            startOnCore(last, p);
+                            continue;
+                        }
+                        if (affinity.park(p, now))
+                        {
+                            schedule(now + affinity_wait, EventType::AffinityTimeout, NULL, 0, 0);
+                            continue;
+                        }
+                    }
+                }
+                startOnCore(i, p);
+            }
+        }
+    }
+
+    // Fill every free core at once, pairing the processes the policy picked
+    // (longest current burst first) with the free cores (fastest first).
+    // Affinity does not apply: the burst decides where a process goes.
+    void dispatchBySpeed()
+    {
+        uint32_t i;
+        std::vector<uint32_t> free_cores;
+        for (i = 0; i < cores.size(); i++)
+        {
+            if (coreFree(i))
+            {
+                free_cores.push_back(i);
+            }
+        }
+        std::vector<Process*> picked;
+        while (picked.size() < free_cores.size() && !ready_queue.empty())
+        {
+            Process *p = ready_queue.pop();
+            if (Policy::PRIORITY_PREEMPTION)
+            {
+                priorities->readyRemoved(p->getPriority());
+            }
+            picked.push_back(p);
+        }
+        std::stable_sort(free_cores.begin(), free_cores.end(), FasterCore(usage));
+        std::stable_sort(picked.begin(), picked.end(), LongerBurst());
+        for (i = 0; i < picked.size(); i++)
+        {
+            startOnCore(free_cores[i], picked[i]);
+        }
+    }
+
+    struct FasterCore {
+        const std::vector<CoreUsage>& usage;
+        FasterCore(const std::vector<CoreUsage>& usage) : usage(usage) {}
+        bool operator ()(uint32_t c1, uint32_t c2) const
+        {
+            return usage[c1].speed > usage[c2].speed;
+        }
+    };
+
+    struct LongerBurst {
+        bool operator ()(Process *p1, Process *p2) const
+        {
+            return p1->getCurrentBurstTime() > p2->getCurrentBurstTime();
+        }
+    };
+
+    // Burst left for the process on `core_id` after the time it has run there
+    uint32_t workLeft(uint32_t core_id, Process *p) const
+    {
+        return workLeftOnCore(p->getCurrentBurstTime(), now - p->getBurstStartTime(), usage[core_id].speed);
+    }
+
+    // A process resuming on a different core first pays the migration penalty,
+    // during which the core is busy and the process is still waiting
+    void startOnCore(uint32_t core_id, Process *p)
+    {
+        int16_t last = p->getLastCore();
+        if (migration_penalty > 0 && last >= 0 && (uint32_t)last != core_id)
+        {
+            CoreState& core = cores[core_id];
+            core.switching = true;
+            core.token++;
+            schedule(now + migration_penalty, EventType::MigrationDone, p, core_id, core.token);
+        }
+        else
+        {
+            startRunning(core_id, p);
+        }
+    }
+
+    void preemptIfNeeded()
+    {
+        uint32_t i;
+        std::vector<uint16_t> victims;
+        priorities->selectVictims(victims);
+        for (i = 0; i < victims.size(); i++)
+        {
+            Process *p = cores[victims[i]].running;
+            policy.ran(p, now - p->getBurstStartTime());
+            p->updateBurstTime(p->get_current_burst_id(), workLeft(victims[i], p));
+            p->setState(Process::State::Ready, now);
+            removeFromCore(victims[i]);
+            makeReady(p);
+            preemptions++;
+        }
+    }
+
+    // every process back to the top level (running ones keep their current slice)
+    void boost()
+    {
+        size_t i;
+        for (i = 0; i < processes.size(); i++)
+        {
+            processes[i].setLevel(0);
+        }
+        ready_queue.boost();
+        affinity.boost();
+        next_boost = now + policy.boostInterval();
+    }
+
+    void startRunning(uint32_t core_id, Process *p)
+    {
+        CoreState& core = cores[core_id];
+        p->setCpuCore(core_id);
+        p->setCoreSpeed(usage[core_id].speed);
+        latencies.dispatched(p, now);
+        p->setState(Process::State::Running, now);
+        p->setBurstStartTime(now);
+        core.running = p;
+        core.token++;
+        if (Policy::PRIORITY_PREEMPTION)
+        {
+            priorities->runningStarted(core_id, p->getPriority());
+        }
+
+        uint64_t burst = runTimeOnCore(p->getCurrentBurstTime(), usage[core_id].speed);
+        // the ready queue is shared: each core competes for its share of it
+        uint32_t runnable = 1 + ready_queue.size() / cores.size();
+        uint32_t slice = Policy::TIME_SLICED ? policy.timeSlice(p, runnable) : 0;
+        if (Policy::TIME_SLICED && slice < burst)
+        {
+            schedule(now + slice, EventType::SliceExpired, p, core_id, core.token);
+        }
+        else
+        {
+            schedule(now + burst, EventType::BurstDone, p, core_id, core.token);
+        }
+    }
+
+    void removeFromCore(uint32_t core_id)
+    {
+        CoreState& core = cores[core_id];
+        if (Policy::PRIORITY_PREEMPTION)
+        {
+            priorities->runningStopped(core_id);
+        }
+        recordCoreBusy(usage[core_id], core.running->getBurstStartTime(), now);
+        core.running->setCpuCore(-1);
+        core.running = NULL;
+        core.switching = true;
+        core.token++;
+        schedule(now + context_switch, EventType::SwitchDone, NULL, core_id, core.token);
+    }
+
+public:
+    PolicySimulator(const SchedulerConfig *config, ProcessTable& processes) :
+        Engine(config), policy(config), processes(processes), affinity(config->cores, config->affinity_wait)
+    {
+        uint32_t i;
+        context_switch = config->context_switch;
+        migration_penalty = config->migration_penalty;
+        affinity_wait = config->affinity_wait;
+        speed_placement = config->speed_placement;
+        usage = coreUsage(config);
+        priorities = Policy::PRIORITY_PREEMPTION ? new PriorityTracker(config->cores) : NULL;
+        next_seq = 0;
+        next_boost = policy.boostInterval();
+
+        cores.resize(config->cores);
+        for (i = 0; i < cores.size(); i++)
+        {
+            cores[i].running = NULL;
+            cores[i].switching = false;
+            cores[i].token = 0;
+        }
+
+        // processes launched at time 0 start out ready, the rest arrive later
+        for (i = 0; i < processes.size(); i++)
+        {
+            Process *p = &processes[i];
+            if (p->getState() == Process::State::Ready)
+            {
+                makeReady(p);
+            }
+            else
+            {
+                schedule(p->getStartTime(), EventType::Arrival, p, 0, 0);
+            }
+        }
+    }
+
+    ~PolicySimulator()
+    {
+        delete priorities;
+    }
+
+    void run()
+    {
+        dispatch();
+        while (!events.empty())
+        {
+            Event event = events.top();
+            events.pop();
+            now = event.time;
+            handleEvent(event);
+            events_processed++;
+
+            // only make scheduling decisions once every event at this instant is
+            // handled, so that simultaneous arrivals compete for the cores fairly
+            if (events.empty() || events.top().time != now)
+            {
+                if (Policy::PERIODIC_BOOST && now >= next_boost)
+                {
+                    boost();
+                }
+                dispatch();
+                if (Policy::PRIORITY_PREEMPTION)
+                {
+                    preemptIfNeeded();
+                }
+            }
+        }
+    }
+};
+
+typedef struct EngineFactory {
+    const SchedulerConfig *config;
+    ProcessTable *processes;
+    Simulator::Engine *engine;
+
+    template <typename Policy>
+    void run()
+    {
+        engine = new PolicySimulator<Policy>(config, *processes);
+    }
+} EngineFactory;
+
+} // namespace
+
+// Simulator class methods
+Simulator::Simulator(const SchedulerConfig *config, ProcessTable& processes)
+{
+    EngineFactory factory;
+    factory.config = config;
+    factory.processes = &processes;
+    withPolicy(config->algorithm, factory);
+    engine = factory.engine;
+}
+
+Simulator::~Simulator()
+{
+    delete engine;
+}
+
+void Simulator::run()
+{
+    engine->run();
+}
+
+uint64_t Simulator::currentTime() const
+{
+    return engine->now;
+}
+
+uint64_t Simulator::eventsProcessed() const
+{
+    return engine->events_processed;
+}
+
+uint64_t Simulator::preemptionCount() const
+{
+    return engine->preemptions;
+}
+
+const SchedulingLatencies& Simulator::schedulingLatencies() const
+{
+    return engine->latencies;
+}
+
+const std::vector<CoreUsage>& Simulator::coreUsage() const
+{
+    return engine->usage;
+}
+
+const IoDevices& Simulator::ioDevices() const
+{
+    return engine->io_devices;
+}
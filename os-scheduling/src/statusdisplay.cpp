@@ -0,0 +1,124 @@
+#include <unistd.h>
+#include "statusdisplay.h"
+
+// StatusDisplay class methods
+StatusDisplay::StatusDisplay(FILE *out, uint32_t refresh_interval)
+{
+    this->out = out;
+    live = isatty(fileno(out));
+    interval = refresh_interval;
+    last_frame = 0;
+    drawn = false;
+}
+
+bool StatusDisplay::update(ProcessTable& processes, uint64_t current_time)
+{
+    size_t i;
+    char line[128];
+    if (!live || (drawn && current_time - last_frame < interval))
+    {
+        return false;
+    }
+
+    next.clear();
+    next.push_back("|   PID | Priority |      State | Core | Turn Time | Wait Time | CPU Time | Remain Time |");
+    next.push_back("+-------+----------+------------+------+-----------+-----------+----------+-------------+");
+    uint32_t not_started = 0;
+    uint32_t terminated = 0;
+    for (i = 0; i < processes.size(); i++)
+    {
+        Process& p = processes[i];
+        Process::Snapshot snap = p.snapshot(current_time);
+        if (snap.state == Process::State::NotStarted)
+        {
+            not_started++;
+            continue;
+        }
+        if (snap.state == Process::State::Terminated)
+        {
+            terminated++;
+            continue;
+        }
+        std::string cpu_core = (snap.core >= 0) ? std::to_string(snap.core) : "--";
+        snprintf(line, sizeof(line), "| %5u | %8u | %10s | %4s | %9.1lf | %9.1lf | %8.1lf | %11.1lf |",
+                 p.getPid(), p.getPriority(), processStateToString(snap.state).c_str(), cpu_core.c_str(),
+                 snap.turn_time / 1000.0, snap.wait_time / 1000.0, snap.cpu_time / 1000.0,
+                 snap.remain_time / 1000.0);
+        next.push_back(line);
+    }
+    snprintf(line, sizeof(line), "  %zu active, %u not started, %u terminated",
+             next.size() - 2, not_started, terminated);
+    next.push_back(line);
+
+    // back to the top of the previous frame, then rewrite only the lines that
+    // differ (a bare newline steps over an unchanged one)
+    buffer.clear();
+    if (drawn && !lines.empty())
+    {
+        buffer += "\033[" + std::to_string(lines.size()) + "A";
+    }
+    for (i = 0; i < next.size(); i++)
+    {
+        if (i < lines.size() && lines[i] == next[i])
+        {
+            buffer += '\n';
+        }
+        else
+        {
+            buffer += "\033[2K";
+            buffer += next[i];
+            buffer += '\n';
+        }
+    }
+    if (lines.size() > next.size())
+    {
+        // the frame shrank: erase what is left of the old one
+        buffer += "\033[J";
+    }
+    fwrite(buffer.data(), 1, buffer.size(), out);
+    fflush(out);
+
+    lines.swap(next);
+    last_frame = current_time;
+    drawn = true;
+    return true;
+}
+
+void StatusDisplay::clear()
+{
+    if (drawn && !lines.empty())
+    {
+        fprintf(out, "\033[%zuA\033[J", lines.size());
+        fflush(out);
+    }
+    lines.clear();
+    drawn = false;
+}
+
+
+std::string processStateToString(Process::State state)
+{
+    std::string str;
+    switch (state)
+    {
+        case Process::State::NotStarted:
+            str = "not started";
+            break;
+        case Process::State::Ready:
+            str = "ready";
+            break;
+        case Process::State::Running:
+            str = "running";
+            break;
+        case Process::State::IO:
+            str = "i/o";
+            break;
+        case Process::State::Terminated:
+            str = "terminated";
+            break;
+        default:
+            str = "unknown";
+            break;
+    }
+    return str;
+}
@@ -0,0 +1,189 @@
+#include <atomic>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include "processtable.h"
+#include "simulator.h"
+#include "sweep.h"
+
+namespace {
+
+// One combination, start to finish. The workload is only read: the
+// instance gets its own copy of the header and of the burst times.
+SweepResult simulate(const SchedulerConfig *workload, const SweepResult& combination)
+{
+    size_t i;
+    SchedulerConfig instance = *workload;
+    instance.algorithm = combination.algorithm;
+    instance.cores = combination.cores;
+    instance.time_slice = combination.time_slice;
+    instance.context_switch = combination.context_switch;
+
+    ProcessTable processes(&instance, 0, ProcessTable::CopyBursts);
+    Simulator simulator(&instance, processes);
+    simulator.run();
+
+    SweepResult result = combination;
+    double cpu = 0.0, turn = 0.0, wait = 0.0;
+    for (i = 0; i < processes.size(); i++)
+    {
+        cpu += processes[i].getCpuTime();
+        turn += processes[i].getTurnaroundTime();
+        wait += processes[i].getWaitTime();
+    }
+    double n = (processes.size() > 0) ? processes.size() : 1;
+    double seconds = simulator.currentTime() / 1000.0;
+    result.makespan = simulator.currentTime();
+    result.cpu_utilization = (seconds > 0.0) ? cpu / (combination.cores * seconds) : 0.0;
+    result.throughput = (seconds > 0.0) ? processes.size() / seconds : 0.0;
+    result.avg_turnaround = turn / n;
+    result.avg_wait = wait / n;
+    result.events = simulator.eventsProcessed();
+    return result;
+}
+
+} // namespace
+
+// "10,20,50" or an inclusive range "first:last:step" (step defaults to 1)
+bool parseSweepValues(const char *text, std::vector<uint32_t>& values)
+{
+    char *end;
+    values.clear();
+    if (strchr(text, ':') != NULL)
+    {
+        unsigned long first = strtoul(text, &end, 10);
+        if (*end != ':')
+        {
+            return false;
+        }
+        unsigned long last = strtoul(end + 1, &end, 10);
+        unsigned long step = 1;
+        if (*end == ':')
+        {
+            step = strtoul(end + 1, &end, 10);
+        }
+        if (*end != '\0' || step == 0 || last < first || last > UINT32_MAX)
+        {
+            return false;
+        }
+        for (unsigned long v = first; v <= last; v += step)
+        {
+            values.push_back(v);
+        }
+        return true;
+    }
+    while (*text != '\0')
+    {
+        unsigned long v = strtoul(text, &end, 10);
+        if (end == text || (*end != ',' && *end != '\0') || v > UINT32_MAX)
+        {
+            return false;
+        }
+        values.push_back(v);
+        text = (*end == ',') ? end + 1 : end;
+    }
+    return !values.empty();
+}
+
+bool parseSweepAlgorithms(const char *text, std::vector<ScheduleAlgorithm>& algorithms)
+{
+    bool ok = true;
+    std::string list(text);
+    size_t pos = 0;
+    algorithms.clear();
+    while (ok && pos <= list.size())
+    {
+        size_t comma = list.find(',', pos);
+        comma = (comma == std::string::npos) ? list.size() : comma;
+        algorithms.push_back(scheduleAlgorithmFromString(list.substr(pos, comma - pos).c_str(), &ok));
+        pos = comma + 1;
+    }
+    return ok;
+}
+
+// Results come back in combination order (algorithm, cores, time slice,
+// context switch), however the workers happened to finish
+std::vector<SweepResult> runSweep(const SchedulerConfig *workload, const SweepParameters& params)
+{
+    size_t a, c, t, s;
+    std::vector<SweepResult> results;
+    for (a = 0; a < params.algorithms.size(); a++)
+    {
+        for (c = 0; c < params.cores.size(); c++)
+        {
+            for (t = 0; t < params.time_slices.size(); t++)
+            {
+                for (s = 0; s < params.context_switches.size(); s++)
+                {
+                    SweepResult combination;
+                    memset(&combination, 0, sizeof(combination));
+                    combination.algorithm = params.algorithms[a];
+                    combination.cores = params.cores[c];
+                    combination.time_slice = params.time_slices[t];
+                    combination.context_switch = params.context_switches[s];
+                    results.push_back(combination);
+                }
+            }
+        }
+    }
+
+    uint32_t jobs = params.jobs;
+    if (jobs == 0)
+    {
+        jobs = std::thread::hardware_concurrency();
+        jobs = (jobs > 0) ? jobs : 1;
+    }
+    jobs = (jobs < results.size()) ? jobs : results.size();
+
+    // each slot of `results` is written by exactly one worker
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    for (a = 0; a < jobs; a++)
+    {
+        workers.push_back(std::thread([&]() {
+            size_t i;
+            while ((i = next++) < results.size())
+            {
+                results[i] = simulate(workload, results[i]);
+            }
+        }));
+    }
+    for (a = 0; a < workers.size(); a++)
+    {
+        workers[a].join();
+    }
+    return results;
+}
+
+void printSweepCsv(FILE *out, const std::vector<SweepResult>& results)
+{
+    size_t i;
+    fprintf(out, "algorithm,cores,time_slice,context_switch,makespan_ms,cpu_utilization,throughput,"
+                 "avg_turnaround,avg_wait,events\n");
+    for (i = 0; i < results.size(); i++)
+    {
+        const SweepResult& r = results[i];
+        fprintf(out, "%s,%u,%u,%u,%" PRIu64 ",%.4f,%.4f,%.3f,%.3f,%" PRIu64 "\n",
+                scheduleAlgorithmToString(r.algorithm), r.cores, r.time_slice, r.context_switch,
+                r.makespan, r.cpu_utilization, r.throughput, r.avg_turnaround, r.avg_wait, r.events);
+    }
+}
+
+void printSweepJson(FILE *out, const std::vector<SweepResult>& results)
+{
+    size_t i;
+    fprintf(out, "[");
+    for (i = 0; i < results.size(); i++)
+    {
+        const SweepResult& r = results[i];
+        fprintf(out, "%s\n  {\"algorithm\": \"%s\", \"cores\": %u, \"time_slice\": %u, \"context_switch\": %u, "
+                "\"makespan_ms\": %" PRIu64 ", \"cpu_utilization\": %.4f, \"throughput\": %.4f, "
+                "\"avg_turnaround\": %.3f, \"avg_wait\": %.3f, \"events\": %" PRIu64 "}",
+                (i == 0) ? "" : ",", scheduleAlgorithmToString(r.algorithm), r.cores, r.time_slice,
+                r.context_switch, r.makespan, r.cpu_utilization, r.throughput, r.avg_turnaround,
+                r.avg_wait, r.events);
+    }
+    fprintf(out, "\n]\n");
+}
@@ -0,0 +1,112 @@
+#include "timerwheel.h"
+
+// TimerWheel class methods
+TimerWheel::TimerWheel(uint64_t start_time)
+{
+    current = start_time;
+    count = 0;
+    level0_count = 0;
+}
+
+void TimerWheel::add(uint64_t deadline, Process *p)
+{
+    Timer timer;
+    timer.deadline = deadline;
+    timer.process = p;
+    place(timer);
+    count++;
+}
+
+// Fire every timer whose deadline is at or before `now`
+void TimerWheel::advance(uint64_t now, std::vector<Process*>& expired)
+{
+    size_t i;
+    while (current <= now)
+    {
+        if (count == 0)
+        {
+            // nothing pending: no need to walk the empty slots
+            current = now + 1;
+            break;
+        }
+
+        uint64_t idx = current & SLOT_MASK;
+        if (idx != 0 && level0_count == 0)
+        {
+            // rest of level 0 is empty: skip to the next cascade point
+            uint64_t next_block = (current | SLOT_MASK) + 1;
+            current = (next_block <= now) ? next_block : now + 1;
+            continue;
+        }
+        if (idx == 0)
+        {
+            // level 0 wrapped: pull the next block of timers down a level
+            // (and from further up whenever that level wrapped as well)
+            int level = 1;
+            while (level < LEVELS && cascade(level))
+            {
+                level++;
+            }
+            if (level == LEVELS)
+            {
+                std::vector<Timer> pending;
+                pending.swap(overflow);
+                for (i = 0; i < pending.size(); i++)
+                {
+                    place(pending[i]);
+                }
+            }
+        }
+
+        std::vector<Timer>& slot = slots[0][idx];
+        for (i = 0; i < slot.size(); i++)
+        {
+            expired.push_back(slot[i].process);
+        }
+        count -= slot.size();
+        level0_count -= slot.size();
+        slot.clear();
+        current++;
+    }
+}
+
+size_t TimerWheel::size() const
+{
+    return count;
+}
+
+// Put a timer in the lowest level whose range covers its deadline
+void TimerWheel::place(const Timer& timer)
+{
+    int level;
+    uint64_t deadline = (timer.deadline < current) ? current : timer.deadline;
+    uint64_t delta = deadline - current;
+    for (level = 0; level < LEVELS; level++)
+    {
+        if (delta < ((uint64_t)1 << (SLOT_BITS * (level + 1))))
+        {
+            slots[level][(deadline >> (SLOT_BITS * level)) & SLOT_MASK].push_back(timer);
+            if (level == 0)
+            {
+                level0_count++;
+            }
+            return;
+        }
+    }
+    overflow.push_back(timer);
+}
+
+// Re-place the timers of the current slot of `level` into the levels below
+// Returns true if that slot was the level's first (so the level above is due too)
+bool TimerWheel::cascade(int level)
+{
+    size_t i;
+    uint64_t idx = (current >> (SLOT_BITS * level)) & SLOT_MASK;
+    std::vector<Timer> pending;
+    pending.swap(slots[level][idx]);
+    for (i = 0; i < pending.size(); i++)
+    {
+        place(pending[i]);
+    }
+    return idx == 0;
+}
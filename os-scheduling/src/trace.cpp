@@ -0,0 +1,194 @@
+#include "trace.h"
+
+#ifdef SCHED_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+// Single-writer ring: only the owning thread pushes, and the exporter reads
+// once every writer has stopped
+typedef struct TraceBuffer {
+    std::string name;
+    int track;
+    TraceRecord *records;
+    uint64_t mask;
+    std::atomic<uint64_t> written;
+} TraceBuffer;
+
+std::mutex registry_mutex;
+std::vector<TraceBuffer*> buffers;
+uint32_t buffer_capacity = 0;
+std::atomic<bool> tracing(false);
+thread_local TraceBuffer *local = NULL;
+
+// Timestamps are TSC ticks where available (a few cycles to read) and are
+// mapped to steady_clock time with two reference points taken at enable()
+// and at export
+uint64_t start_ticks;
+std::chrono::steady_clock::time_point start_time;
+
+inline uint64_t ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+const char *EVENT_NAMES[] = {
+    "dispatch", "preempt", "burst end", "I/O start", "I/O end",
+    "terminate", "switch start", "switch end", "arrival", "interrupt"
+};
+
+} // namespace
+
+void Trace::enable(uint32_t capacity)
+{
+    // round up to a power of two so the ring index is a mask
+    uint32_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+    buffer_capacity = size;
+    start_ticks = ticks();
+    start_time = std::chrono::steady_clock::now();
+    tracing = true;
+}
+
+bool Trace::enabled()
+{
+    return tracing;
+}
+
+void Trace::registerThread(const char *name, int track)
+{
+    if (!tracing)
+    {
+        return;
+    }
+    TraceBuffer *buffer = new TraceBuffer();
+    buffer->name = name;
+    buffer->track = track;
+    buffer->records = new TraceRecord[buffer_capacity];
+    buffer->mask = buffer_capacity - 1;
+    buffer->written = 0;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    buffers.push_back(buffer);
+    local = buffer;
+}
+
+void Trace::record(TraceEvent event, uint32_t pid, int16_t core)
+{
+    TraceBuffer *buffer = local;
+    if (buffer == NULL)
+    {
+        return;
+    }
+    uint64_t n = buffer->written.load(std::memory_order_relaxed);
+    TraceRecord& r = buffer->records[n & buffer->mask];
+    r.timestamp = ticks();
+    r.pid = pid;
+    r.core = core;
+    r.event = event;
+    buffer->written.store(n + 1, std::memory_order_release);
+}
+
+// Each core track gets one slice per dispatch (until its preempt/burst end)
+// and per context switch; I/O bursts become async slices keyed by pid, and
+// everything else is an instant event on the thread that recorded it.
+bool Trace::writeChromeTrace(const char *filename)
+{
+    size_t b;
+    uint64_t i;
+    FILE *out = fopen(filename, "w");
+    if (out == NULL)
+    {
+        return false;
+    }
+
+    uint64_t end_ticks = ticks();
+    double elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+    double us_per_tick = (end_ticks > start_ticks) ? elapsed_us / (end_ticks - start_ticks) : 0.0;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    bool first = true;
+    uint64_t dropped = 0;
+    fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    for (b = 0; b < buffers.size(); b++)
+    {
+        TraceBuffer *buffer = buffers[b];
+        fprintf(out, "%s\n{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+                first ? "" : ",", buffer->track, buffer->name.c_str());
+        fprintf(out, ",\n{\"ph\": \"M\", \"name\": \"thread_sort_index\", \"pid\": 1, \"tid\": %d, \"args\": {\"sort_index\": %d}}",
+                buffer->track, buffer->track);
+        first = false;
+
+        uint64_t written = buffer->written.load(std::memory_order_acquire);
+        uint64_t oldest = (written > buffer->mask + 1) ? written - (buffer->mask + 1) : 0;
+        dropped += oldest;
+
+        const TraceRecord *running = NULL;
+        const TraceRecord *switching = NULL;
+        for (i = oldest; i < written; i++)
+        {
+            const TraceRecord& r = buffer->records[i & buffer->mask];
+            double ts = (r.timestamp - start_ticks) * us_per_tick;
+            switch (r.event)
+            {
+                case TraceDispatch:
+                    running = &r;
+                    break;
+                case TracePreempt:
+                case TraceBurstEnd:
+                    if (running != NULL)
+                    {
+                        double begin = (running->timestamp - start_ticks) * us_per_tick;
+                        fprintf(out, ",\n{\"ph\": \"X\", \"name\": \"pid %u\", \"cat\": \"run\", \"pid\": 1, \"tid\": %d, "
+                                "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"end\": \"%s\"}}",
+                                running->pid, buffer->track, begin, ts - begin, EVENT_NAMES[r.event]);
+                        running = NULL;
+                    }
+                    break;
+                case TraceSwitchStart:
+                    switching = &r;
+                    break;
+                case TraceSwitchEnd:
+                    if (switching != NULL)
+                    {
+                        double begin = (switching->timestamp - start_ticks) * us_per_tick;
+                        fprintf(out, ",\n{\"ph\": \"X\", \"name\": \"context switch\", \"cat\": \"switch\", \"pid\": 1, "
+                                "\"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}", buffer->track, begin, ts - begin);
+                        switching = NULL;
+                    }
+                    break;
+                case TraceIoStart:
+                case TraceIoEnd:
+                    fprintf(out, ",\n{\"ph\": \"%s\", \"name\": \"I/O pid %u\", \"cat\": \"io\", \"id\": %u, \"pid\": 1, "
+                            "\"tid\": %d, \"ts\": %.3f}", (r.event == TraceIoStart) ? "b" : "e", r.pid, r.pid,
+                            buffer->track, ts);
+                    break;
+                default:
+                    fprintf(out, ",\n{\"ph\": \"i\", \"s\": \"t\", \"name\": \"%s\", \"pid\": 1, \"tid\": %d, "
+                            "\"ts\": %.3f, \"args\": {\"pid\": %u, \"core\": %d}}",
+                            EVENT_NAMES[r.event], buffer->track, ts, r.pid, r.core);
+                    break;
+            }
+        }
+    }
+    fprintf(out, "\n], \"otherData\": {\"dropped_records\": %llu}}\n", (unsigned long long)dropped);
+    return fclose(out) == 0;
+}
+
+#endif // SCHED_TRACE
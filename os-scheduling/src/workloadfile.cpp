@@ -0,0 +1,421 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "workloadfile.h"
+
+namespace {
+
+void putLe32(uint8_t *p, uint32_t value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+}
+
+void putLe64(uint8_t *p, uint64_t value)
+{
+    putLe32(p, (uint32_t)value);
+    putLe32(p + 4, (uint32_t)(value >> 32));
+}
+
+uint32_t getLe32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+uint64_t getLe64(const uint8_t *p)
+{
+    return (uint64_t)getLe32(p) | ((uint64_t)getLe32(p + 4) << 32);
+}
+
+bool hostIsLittleEndian()
+{
+    return __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+}
+
+// Core speeds follow the header, then the burst array; the process table
+// follows that, 8 byte aligned
+uint64_t burstArrayOffset(uint32_t num_core_speeds)
+{
+    return WORKLOAD_HEADER_SIZE + num_core_speeds * sizeof(uint32_t);
+}
+
+uint64_t processTableOffset(uint32_t num_core_speeds, uint64_t num_bursts)
+{
+    return (burstArrayOffset(num_core_speeds) + num_bursts * sizeof(uint32_t) + 7) & ~(uint64_t)7;
+}
+
+bool writeFailed(const char *what, std::string& error)
+{
+    error = std::string(what) + ": " + strerror(errno);
+    return false;
+}
+
+} // namespace
+
+
+// WorkloadWriter class methods
+WorkloadWriter::WorkloadWriter()
+{
+    file = NULL;
+    table = NULL;
+}
+
+WorkloadWriter::~WorkloadWriter()
+{
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+    if (table != NULL)
+    {
+        fclose(table);
+    }
+}
+
+bool WorkloadWriter::open(const char *filename, uint16_t cores, ScheduleAlgorithm algorithm,
+                          uint32_t context_switch, uint32_t time_slice, const uint16_t *core_speeds,
+                          uint16_t num_core_speeds, std::string& error)
+{
+    uint32_t i;
+    uint8_t header[WORKLOAD_HEADER_SIZE];
+    file = fopen(filename, "wb");
+    if (file == NULL)
+    {
+        return writeFailed("cannot create file", error);
+    }
+    table = tmpfile();
+    if (table == NULL)
+    {
+        return writeFailed("cannot create temporary file", error);
+    }
+    this->cores = cores;
+    this->algorithm = algorithm;
+    this->context_switch = context_switch;
+    this->time_slice = time_slice;
+    this->num_core_speeds = num_core_speeds;
+    num_processes = 0;
+    num_bursts = 0;
+
+    // placeholder until the counts are known
+    memset(header, 0, sizeof(header));
+    if (fwrite(header, sizeof(header), 1, file) != 1)
+    {
+        return writeFailed("write failed", error);
+    }
+    for (i = 0; i < num_core_speeds; i++)
+    {
+        uint8_t speed[sizeof(uint32_t)];
+        putLe32(speed, core_speeds[i]);
+        if (fwrite(speed, sizeof(speed), 1, file) != 1)
+        {
+            return writeFailed("write failed", error);
+        }
+    }
+    return true;
+}
+
+bool WorkloadWriter::add(const ProcessDetails& details, std::string& error)
+{
+    return add(details.pid, details.start_time, details.priority, details.burst_times,
+               details.num_bursts, error);
+}
+
+// Raw form of add(): the file's fields are wider than ProcessDetails', so
+// generated workloads aren't limited to 16-bit pids
+bool WorkloadWriter::add(uint32_t pid, uint32_t start_time, uint8_t priority, const uint32_t *burst_times,
+                         uint32_t count, std::string& error)
+{
+    uint32_t i;
+    uint8_t buffer[4096];
+    uint8_t record[WORKLOAD_RECORD_SIZE];
+    if (num_processes == UINT32_MAX)
+    {
+        error = "too many processes";
+        return false;
+    }
+
+    size_t used = 0;
+    for (i = 0; i < count; i++)
+    {
+        if (used == sizeof(buffer))
+        {
+            if (fwrite(buffer, used, 1, file) != 1)
+            {
+                return writeFailed("write failed", error);
+            }
+            used = 0;
+        }
+        putLe32(buffer + used, burst_times[i]);
+        used += sizeof(uint32_t);
+    }
+    if (used > 0 && fwrite(buffer, used, 1, file) != 1)
+    {
+        return writeFailed("write failed", error);
+    }
+
+    memset(record, 0, sizeof(record));
+    putLe32(record, pid);
+    putLe32(record + 4, start_time);
+    putLe32(record + 8, count);
+    record[12] = priority;
+    putLe64(record + 16, num_bursts);
+    if (fwrite(record, sizeof(record), 1, table) != 1)
+    {
+        return writeFailed("write to temporary file failed", error);
+    }
+    num_processes++;
+    num_bursts += count;
+    return true;
+}
+
+bool WorkloadWriter::close(std::string& error)
+{
+    uint8_t buffer[65536];
+    uint8_t header[WORKLOAD_HEADER_SIZE];
+    size_t n;
+
+    // pad the burst array out to the process table, then append the table
+    static const uint8_t zeros[8] = { 0 };
+    uint64_t table_offset = processTableOffset(num_core_speeds, num_bursts);
+    size_t padding = table_offset - (burstArrayOffset(num_core_speeds) + num_bursts * sizeof(uint32_t));
+    if (padding > 0 && fwrite(zeros, padding, 1, file) != 1)
+    {
+        return writeFailed("write failed", error);
+    }
+    rewind(table);
+    while ((n = fread(buffer, 1, sizeof(buffer), table)) > 0)
+    {
+        if (fwrite(buffer, n, 1, file) != 1)
+        {
+            return writeFailed("write failed", error);
+        }
+    }
+    if (ferror(table))
+    {
+        return writeFailed("read from temporary file failed", error);
+    }
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, WORKLOAD_MAGIC, sizeof(WORKLOAD_MAGIC));
+    putLe32(header + 8, WORKLOAD_VERSION);
+    putLe32(header + 12, WORKLOAD_HEADER_SIZE);
+    putLe32(header + 16, cores);
+    putLe32(header + 20, algorithm);
+    putLe32(header + 24, context_switch);
+    putLe32(header + 28, time_slice);
+    putLe32(header + 32, num_processes);
+    putLe32(header + 36, num_core_speeds);
+    putLe64(header + 40, num_bursts);
+    putLe64(header + 48, table_offset);
+    putLe64(header + 56, burstArrayOffset(num_core_speeds));
+    if (fseek(file, 0, SEEK_SET) != 0 || fwrite(header, sizeof(header), 1, file) != 1)
+    {
+        return writeFailed("write failed", error);
+    }
+
+    fclose(table);
+    table = NULL;
+    int result = fclose(file);
+    file = NULL;
+    if (result != 0)
+    {
+        return writeFailed("write failed", error);
+    }
+    return true;
+}
+
+
+bool writeBinaryConfig(const SchedulerConfig *config, const char *filename, std::string& error)
+{
+    int i;
+    WorkloadWriter writer;
+    if (!writer.open(filename, config->cores, config->algorithm, config->context_switch,
+                     config->time_slice, config->core_speeds, config->num_core_speeds, error))
+    {
+        return false;
+    }
+    for (i = 0; i < config->num_processes; i++)
+    {
+        if (!writer.add(config->processes[i], error))
+        {
+            return false;
+        }
+    }
+    return writer.close(error);
+}
+
+// Map a binary workload and build the process list on top of it. The mapping
+// is private and writable, so the burst times can be handed out as ordinary
+// uint32_t arrays: pages are only copied if something writes to them.
+SchedulerConfig* readBinaryConfig(const char *filename, std::string& error)
+{
+    uint64_t i;
+    error.clear();
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        error = std::string("cannot open file: ") + strerror(errno);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < WORKLOAD_HEADER_SIZE)
+    {
+        error = "file is too short for a workload header";
+        close(fd);
+        return NULL;
+    }
+    uint64_t size = st.st_size;
+    void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        error = std::string("cannot map file: ") + strerror(errno);
+        return NULL;
+    }
+    const uint8_t *base = (const uint8_t *)data;
+
+    // header
+    uint32_t version = getLe32(base + 8);
+    uint32_t header_size = getLe32(base + 12);
+    uint32_t cores = getLe32(base + 16);
+    uint32_t algorithm = getLe32(base + 20);
+    uint32_t num_processes = getLe32(base + 32);
+    uint32_t num_core_speeds = getLe32(base + 36);
+    uint64_t num_bursts = getLe64(base + 40);
+    uint64_t table_offset = getLe64(base + 48);
+    uint64_t burst_offset = getLe64(base + 56);
+    if (memcmp(base, WORKLOAD_MAGIC, sizeof(WORKLOAD_MAGIC)) != 0)
+    {
+        error = "not a binary workload file";
+    }
+    else if (version != WORKLOAD_VERSION)
+    {
+        error = "unsupported workload version " + std::to_string(version);
+    }
+    else if (header_size < WORKLOAD_HEADER_SIZE)
+    {
+        error = "bad header size " + std::to_string(header_size);
+    }
+    else if (cores == 0 || cores > MAX_CORES)
+    {
+        error = "bad number of cores (" + std::to_string(cores) + ")";
+    }
+    else if (algorithm > ScheduleAlgorithm::CFS)
+    {
+        error = "unknown scheduling algorithm " + std::to_string(algorithm);
+    }
+    else if (num_processes > MAX_PROCESSES)
+    {
+        error = "too many processes (" + std::to_string(num_processes) + ")";
+    }
+    else if (num_core_speeds > cores || header_size + (uint64_t)num_core_speeds * sizeof(uint32_t) > size)
+    {
+        error = "bad core speed table (" + std::to_string(num_core_speeds) + " entries)";
+    }
+    else if (burst_offset % sizeof(uint32_t) != 0 || burst_offset > size ||
+             num_bursts > (size - burst_offset) / sizeof(uint32_t))
+    {
+        error = "burst array runs past the end of the file";
+    }
+    else if (table_offset > size || num_processes > (size - table_offset) / WORKLOAD_RECORD_SIZE)
+    {
+        error = "process table runs past the end of the file";
+    }
+    if (!error.empty())
+    {
+        munmap(data, size);
+        return NULL;
+    }
+
+    SchedulerConfig *config = new SchedulerConfig();
+    config->cores = cores;
+    config->algorithm = (ScheduleAlgorithm)algorithm;
+    config->context_switch = getLe32(base + 24);
+    config->time_slice = getLe32(base + 28);
+    config->num_processes = num_processes;
+    config->processes = new ProcessDetails[num_processes];
+    config->mapping = data;
+    config->mapping_size = size;
+    if (num_core_speeds > 0)
+    {
+        config->num_core_speeds = num_core_speeds;
+        config->core_speeds = new uint16_t[num_core_speeds];
+        for (i = 0; i < num_core_speeds; i++)
+        {
+            uint32_t speed = getLe32(base + header_size + i * sizeof(uint32_t));
+            config->core_speeds[i] = (speed > 0 && speed <= UINT16_MAX) ? speed : BASE_CORE_SPEED;
+        }
+    }
+
+    uint32_t *bursts = (uint32_t *)((uint8_t *)data + burst_offset);
+    if (!hostIsLittleEndian())
+    {
+        // the file is little-endian: only big-endian hosts pay for a copy
+        config->burst_storage = new uint32_t[num_bursts];
+        for (i = 0; i < num_bursts; i++)
+        {
+            config->burst_storage[i] = getLe32((const uint8_t *)(bursts + i));
+        }
+        bursts = config->burst_storage;
+    }
+
+    const uint8_t *record = base + table_offset;
+    uintptr_t page = (uintptr_t)record & ~(uintptr_t)(sysconf(_SC_PAGESIZE) - 1);
+    madvise((void *)page, (uintptr_t)record - page + (uint64_t)num_processes * WORKLOAD_RECORD_SIZE,
+            MADV_SEQUENTIAL);
+    for (i = 0; i < num_processes; i++, record += WORKLOAD_RECORD_SIZE)
+    {
+        ProcessDetails& details = config->processes[i];
+        uint32_t pid = getLe32(record);
+        uint32_t count = getLe32(record + 8);
+        uint64_t first = getLe64(record + 16);
+        if (count == 0 || count > UINT16_MAX)
+        {
+            error = "process " + std::to_string(i) + ": bad burst count " + std::to_string(count);
+        }
+        else if (first > num_bursts || count > num_bursts - first)
+        {
+            error = "process " + std::to_string(i) + ": bursts out of range";
+        }
+        if (!error.empty())
+        {
+            deleteConfig(config);
+            return NULL;
+        }
+        details.pid = pid;
+        details.start_time = getLe32(record + 4);
+        details.num_bursts = count;
+        details.burst_times = bursts + first;
+        details.priority = record[12];
+    }
+    return config;
+}
+
+bool isBinaryConfig(const char *filename)
+{
+    char magic[sizeof(WORKLOAD_MAGIC)];
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    bool binary = fread(magic, sizeof(magic), 1, file) == 1 &&
+                  memcmp(magic, WORKLOAD_MAGIC, sizeof(magic)) == 0;
+    fclose(file);
+    return binary;
+}
+
+// Load either workload format, telling them apart by the binary magic
+SchedulerConfig* loadWorkload(const char *filename, std::string& error)
+{
+    if (isBinaryConfig(filename))
+    {
+        return readBinaryConfig(filename, error);
+    }
+    return readConfigFileFast(filename, error);
+}
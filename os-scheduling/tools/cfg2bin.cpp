@@ -0,0 +1,90 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/stat.h>
+#include "configreader.h"
+#include "workloadfile.h"
+
+// Converter: text config file -> binary workload file. Reads the result back
+// to check it and compares how long each format takes to load.
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double fileMegabytes(const char *filename)
+{
+    struct stat st;
+    return (stat(filename, &st) == 0) ? st.st_size / (1024.0 * 1024.0) : 0.0;
+}
+
+bool sameConfig(const SchedulerConfig *a, const SchedulerConfig *b)
+{
+    int i, j;
+    if (a->cores != b->cores || a->algorithm != b->algorithm || a->context_switch != b->context_switch ||
+        a->time_slice != b->time_slice || a->num_processes != b->num_processes)
+    {
+        return false;
+    }
+    for (i = 0; i < a->num_processes; i++)
+    {
+        const ProcessDetails& p = a->processes[i];
+        const ProcessDetails& q = b->processes[i];
+        if (p.pid != q.pid || p.start_time != q.start_time || p.num_bursts != q.num_bursts ||
+            p.priority != q.priority)
+        {
+            return false;
+        }
+        for (j = 0; j < p.num_bursts; j++)
+        {
+            if (p.burst_times[j] != q.burst_times[j])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: cfg2bin <config_file> <workload_file>" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::string error;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    SchedulerConfig *text = readConfigFileFast(argv[1], error);
+    double text_time = secondsSince(start);
+    if (text == NULL)
+    {
+        std::cerr << "Error: " << argv[1] << ": " << error << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (!writeBinaryConfig(text, argv[2], error))
+    {
+        std::cerr << "Error: " << argv[2] << ": " << error << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    start = std::chrono::steady_clock::now();
+    SchedulerConfig *binary = readBinaryConfig(argv[2], error);
+    double binary_time = secondsSince(start);
+    if (binary == NULL)
+    {
+        std::cerr << "Error: " << argv[2] << ": " << error << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    bool same = sameConfig(text, binary);
+
+    printf("%u processes: %.2f MB text -> %.2f MB binary\n", text->num_processes,
+           fileMegabytes(argv[1]), fileMegabytes(argv[2]));
+    printf("load time: text %.3f ms, binary %.3f ms\n", text_time * 1000.0, binary_time * 1000.0);
+    printf("round trip: %s\n", same ? "identical" : "MISMATCH");
+    deleteConfig(text);
+    deleteConfig(binary);
+    return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
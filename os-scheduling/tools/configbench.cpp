@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/stat.h>
+#include "configreader.h"
+
+// Load-time benchmark: readConfigFile (getline/stringstream/stoi) against
+// readConfigFileFast (mmap + in-place parse) on the same config file
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool sameConfig(const SchedulerConfig *a, const SchedulerConfig *b)
+{
+    int i, j;
+    if (a->cores != b->cores || a->algorithm != b->algorithm || a->context_switch != b->context_switch ||
+        a->time_slice != b->time_slice || a->num_processes != b->num_processes)
+    {
+        return false;
+    }
+    for (i = 0; i < a->cores; i++)
+    {
+        if (coreSpeed(a, i) != coreSpeed(b, i))
+        {
+            return false;
+        }
+    }
+    for (i = 0; i < a->num_processes; i++)
+    {
+        const ProcessDetails& p = a->processes[i];
+        const ProcessDetails& q = b->processes[i];
+        // readConfigFile only keeps priorities for PP and CFS
+        if (p.pid != q.pid || p.start_time != q.start_time || p.num_bursts != q.num_bursts ||
+            ((a->algorithm == PP || a->algorithm == CFS) && p.priority != q.priority))
+        {
+            return false;
+        }
+        for (j = 0; j < p.num_bursts; j++)
+        {
+            if (p.burst_times[j] != q.burst_times[j])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: configbench <config_file> [iterations]" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    int i;
+    int iterations = (argc > 2) ? atoi(argv[2]) : 5;
+    struct stat st;
+    if (stat(argv[1], &st) != 0 || iterations < 1)
+    {
+        std::cerr << "Error: cannot read " << argv[1] << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    double mb = st.st_size / (1024.0 * 1024.0);
+
+    std::string error;
+    SchedulerConfig *fast = readConfigFileFast(argv[1], error);
+    if (fast == NULL)
+    {
+        std::cerr << "Error: " << argv[1] << ": " << error << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    SchedulerConfig *slow = readConfigFile(argv[1]);
+    bool same = sameConfig(fast, slow);
+    deleteConfig(fast);
+    deleteConfig(slow);
+
+    double best_slow = 0, best_fast = 0;
+    for (i = 0; i < iterations; i++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        SchedulerConfig *config = readConfigFile(argv[1]);
+        double t = secondsSince(start);
+        deleteConfig(config);
+        best_slow = (i == 0 || t < best_slow) ? t : best_slow;
+
+        start = std::chrono::steady_clock::now();
+        config = readConfigFileFast(argv[1], error);
+        t = secondsSince(start);
+        deleteConfig(config);
+        best_fast = (i == 0 || t < best_fast) ? t : best_fast;
+    }
+
+    printf("%s: %.1f MB, best of %d loads\n", argv[1], mb, iterations);
+    printf("  readConfigFile     %10.3f ms  %8.1f MB/s\n", best_slow * 1000.0, mb / best_slow);
+    printf("  readConfigFileFast %10.3f ms  %8.1f MB/s\n", best_fast * 1000.0, mb / best_fast);
+    printf("  speedup %.1fx, results %s\n", best_slow / best_fast, same ? "identical" : "DIFFER");
+    return same ? 0 : 1;
+}
@@ -0,0 +1,406 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "configreader.h"
+#include "corepool.h"
+#include "process.h"
+#include "processtable.h"
+#include "readyqueue.h"
+#include "runqueues.h"
+#include "simulator.h"
+#include "trace.h"
+
+// Scheduler overhead benchmarks (run by `make bench`), written as JSON:
+//  - queue_push_pop: ready queue pop + push with `processes` queued
+//  - comparator:     one SjfComparator / PpComparator call on random pairs
+//  - dispatch:       RunQueues::enqueueBatch() of one process until a parked
+//                    core (on a ThreadExecutor) has taken it
+//  - simulate:       discrete-event Simulator events per second
+//  - trace_event:    one TRACE_EVENT() into the calling thread's ring
+//                    (only when built with make TRACE=1)
+// Each is swept over algorithms, core counts and process counts wherever
+// that parameter means something for it.
+
+typedef std::chrono::steady_clock Clock;
+
+const ScheduleAlgorithm ALGORITHMS[] = { FCFS, SJF, RR, PP, MLFQ, CFS };
+const char *ALGORITHM_NAMES[] = { "FCFS", "SJF", "RR", "PP", "MLFQ", "CFS" };
+
+double nanosSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// Random workload in memory: exponential arrivals and bursts, priorities 0-4
+SchedulerConfig* makeConfig(uint32_t num_processes, uint16_t cores, ScheduleAlgorithm algorithm,
+                            std::mt19937_64& rng)
+{
+    uint32_t i, j;
+    std::exponential_distribution<double> arrival(1.0 / 20.0);
+    std::exponential_distribution<double> burst(1.0 / 200.0);
+    std::geometric_distribution<int> cpu_bursts(1.0 / 3.0);
+    std::uniform_int_distribution<int> priority(0, 4);
+
+    SchedulerConfig *config = new SchedulerConfig();
+    config->cores = cores;
+    config->algorithm = algorithm;
+    config->context_switch = 5;
+    config->time_slice = 100;
+    config->num_processes = num_processes;
+    config->processes = new ProcessDetails[num_processes];
+
+    std::vector<uint32_t> bursts;
+    std::vector<uint32_t> counts(num_processes);
+    for (i = 0; i < num_processes; i++)
+    {
+        counts[i] = 2 * std::min(cpu_bursts(rng) + 1, 100) - 1;
+        for (j = 0; j < counts[i]; j++)
+        {
+            bursts.push_back(1 + (uint32_t)burst(rng));
+        }
+    }
+    config->burst_storage = new uint32_t[bursts.size()];
+    std::copy(bursts.begin(), bursts.end(), config->burst_storage);
+
+    double time = 0.0;
+    uint32_t *next = config->burst_storage;
+    for (i = 0; i < num_processes; i++)
+    {
+        ProcessDetails& details = config->processes[i];
+        details.pid = i;
+        details.start_time = (uint32_t)time;
+        details.num_bursts = counts[i];
+        details.burst_times = next;
+        details.priority = priority(rng);
+        next += counts[i];
+        time += arrival(rng);
+    }
+    return config;
+}
+
+// Process pool of any size: a config (and so a ProcessTable) holds at most
+// MAX_PROCESSES processes, so bigger pools are made of several tables
+class ProcessPool {
+private:
+    std::vector<ProcessTable*> tables;
+
+public:
+    std::vector<Process*> processes;
+
+    ProcessPool(uint32_t count, ScheduleAlgorithm algorithm, std::mt19937_64& rng)
+    {
+        size_t i;
+        while (processes.size() < count)
+        {
+            uint32_t n = std::min<uint32_t>(count - processes.size(), MAX_PROCESSES);
+            SchedulerConfig *config = makeConfig(n, 1, algorithm, rng);
+            ProcessTable *table = new ProcessTable(config, 0);
+            deleteConfig(config);
+            for (i = 0; i < table->size(); i++)
+            {
+                processes.push_back(&(*table)[i]);
+            }
+            tables.push_back(table);
+        }
+    }
+
+    ~ProcessPool()
+    {
+        size_t i;
+        for (i = 0; i < tables.size(); i++)
+        {
+            delete tables[i];
+        }
+    }
+};
+
+class JsonWriter {
+private:
+    FILE *out;
+    bool first;
+
+public:
+    JsonWriter(FILE *out, const std::string& label) : out(out), first(true)
+    {
+        fprintf(out, "{\n  \"label\": \"%s\",\n  \"results\": [", label.c_str());
+    }
+
+    void result(const char *benchmark, const char *algorithm, int cores, uint32_t processes,
+                const char *metric, double value)
+    {
+        fprintf(out, "%s\n    {\"benchmark\": \"%s\", \"algorithm\": \"%s\", \"cores\": %d, "
+                "\"processes\": %u, \"%s\": %.3f}", first ? "" : ",", benchmark, algorithm, cores,
+                processes, metric, value);
+        fflush(out);
+        first = false;
+    }
+
+    void finish()
+    {
+        fprintf(out, "\n  ]\n}\n");
+    }
+};
+
+// Steady-state ready queue cost: the queue holds every process in the pool,
+// and each operation pops the front process and pushes it back
+double benchQueue(ScheduleAlgorithm algorithm, ProcessPool& pool, uint32_t operations)
+{
+    uint32_t i;
+    ReadyQueue *queue = createReadyQueue(algorithm);
+    for (i = 0; i < pool.processes.size(); i++)
+    {
+        queue->push(pool.processes[i]);
+    }
+    Clock::time_point start = Clock::now();
+    for (i = 0; i < operations; i++)
+    {
+        queue->push(queue->pop());
+    }
+    double ns = nanosSince(start) / operations;
+    delete queue;
+    return ns;
+}
+
+template <typename Compare>
+double benchComparator(ProcessPool& pool, uint32_t operations)
+{
+    uint32_t i;
+    Compare compare;
+    std::mt19937 rng(1);
+    std::vector<uint32_t> picks(operations + 1);
+    for (i = 0; i <= operations; i++)
+    {
+        picks[i] = rng() % pool.processes.size();
+    }
+    volatile uint32_t sink = 0;
+    Clock::time_point start = Clock::now();
+    for (i = 0; i < operations; i++)
+    {
+        sink += compare(pool.processes[picks[i]], pool.processes[picks[i + 1]]);
+    }
+    return nanosSince(start) / operations;
+}
+
+// A core that only takes processes and hands them straight back, parking
+// like the scheduler's cores when its queue is empty
+class DispatchCore : public CoreTask {
+private:
+    uint16_t core_id;
+    RunQueues *run_queues;
+    const std::atomic<bool> *done;
+    std::function<void(Process*)> taken;
+    bool parked;
+
+public:
+    DispatchCore(uint16_t core_id, RunQueues *run_queues, const std::atomic<bool> *done,
+                 std::function<void(Process*)> taken) :
+        core_id(core_id), run_queues(run_queues), done(done), taken(taken), parked(false) {}
+
+    uint64_t step(uint64_t now, uint32_t worker)
+    {
+        while (!*done)
+        {
+            Process *p;
+            if (run_queues->takeBatch(core_id, &p, 1) == 0)
+            {
+                parked = run_queues->park(core_id);
+                if (parked)
+                {
+                    return WAIT;
+                }
+                continue;
+            }
+            if (parked)
+            {
+                run_queues->unpark(core_id);
+                parked = false;
+            }
+            taken(p);
+        }
+        return FINISHED;
+    }
+};
+
+// One process at a time is queued while every core is parked; the time
+// until a core has taken it covers placement, queue locking, the wakeup
+// through the core's executor and the core's step. Returns the median
+// latency (ns).
+double benchDispatch(ScheduleAlgorithm algorithm, uint16_t cores, ProcessPool& pool, uint32_t samples)
+{
+    uint32_t i;
+    RunQueues run_queues(RunQueues::Mode::PerCore, algorithm, cores, 0);
+    ThreadExecutor executor(cores);
+    run_queues.setWaker(&executor);
+    std::atomic<uint32_t> taken(0);
+    std::atomic<bool> done(false);
+    std::vector<double> latencies(samples);
+    Clock::time_point enqueued_at;
+
+    std::function<void(Process*)> record = [&](Process *p) {
+        double ns = nanosSince(enqueued_at);
+        {
+            std::unique_lock<ProfiledMutex> lock = run_queues.lockProcess(p, LOCK_SITE("bench: release"));
+            run_queues.release(p);
+        }
+        latencies[taken] = ns;
+        taken++;
+    };
+    std::vector<CoreTask*> tasks;
+    for (i = 0; i < cores; i++)
+    {
+        tasks.push_back(new DispatchCore(i, &run_queues, &done, record));
+    }
+    executor.start(tasks);
+
+    std::vector<Process*> batch(1);
+    for (i = 0; i < samples; i++)
+    {
+        batch[0] = pool.processes[i % pool.processes.size()];
+        enqueued_at = Clock::now();
+        run_queues.enqueueBatch(batch);
+        while (taken == i)
+        {
+            std::this_thread::yield();
+        }
+    }
+    done = true;
+    run_queues.wakeAll();
+    executor.join();
+    for (i = 0; i < tasks.size(); i++)
+    {
+        delete tasks[i];
+    }
+    std::sort(latencies.begin(), latencies.end());
+    return latencies[samples / 2];
+}
+
+#ifdef SCHED_TRACE
+double benchTraceEvent(uint32_t operations)
+{
+    uint32_t i;
+    TRACE_THREAD("schedbench", 0);
+    Clock::time_point start = Clock::now();
+    for (i = 0; i < operations; i++)
+    {
+        TRACE_EVENT(TraceDispatch, i, 0);
+    }
+    return nanosSince(start) / operations;
+}
+#endif
+
+double benchSimulate(ScheduleAlgorithm algorithm, uint16_t cores, uint32_t num_processes, std::mt19937_64& rng)
+{
+    SchedulerConfig *config = makeConfig(num_processes, cores, algorithm, rng);
+    ProcessTable processes(config, 0);
+    Simulator simulator(config, processes);
+    deleteConfig(config);
+    Clock::time_point start = Clock::now();
+    simulator.run();
+    double seconds = nanosSince(start) / 1e9;
+    return simulator.eventsProcessed() / seconds;
+}
+
+int main(int argc, char **argv)
+{
+    int a;
+    size_t i, j, k;
+    bool quick = false;
+    std::string label = "unlabelled";
+    const char *output = NULL;
+    for (a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "--quick") == 0)
+        {
+            quick = true;
+        }
+        else if (strncmp(argv[a], "--label=", 8) == 0)
+        {
+            label = argv[a] + 8;
+        }
+        else if (strncmp(argv[a], "--output=", 9) == 0)
+        {
+            output = argv[a] + 9;
+        }
+        else
+        {
+            std::cerr << "Usage: schedbench [--quick] [--label=NAME] [--output=FILE]" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    FILE *out = (output != NULL) ? fopen(output, "w") : stdout;
+    if (out == NULL)
+    {
+        std::cerr << "Error: cannot create " << output << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<uint32_t> pool_sizes = { 10, 1000, 100000, 1000000 };
+    std::vector<uint32_t> sim_sizes = { 10, 1000, 65535 };     // the old config limit, kept comparable
+    std::vector<int> core_counts = { 1, 4, 16, 64 };
+    uint32_t operations = 1000000;
+    uint32_t samples = 2000;
+    if (quick)
+    {
+        pool_sizes = { 10, 1000, 10000 };
+        sim_sizes = { 10, 1000 };
+        core_counts = { 1, 4 };
+        operations = 100000;
+        samples = 200;
+    }
+
+    JsonWriter json(out, label);
+#ifdef SCHED_TRACE
+    Trace::enable(1 << 16);
+    json.result("trace_event", "", 0, 0, "ns_per_op", benchTraceEvent(operations));
+#endif
+    std::mt19937_64 rng(42);
+    for (i = 0; i < sizeof(ALGORITHMS) / sizeof(ALGORITHMS[0]); i++)
+    {
+        ScheduleAlgorithm algorithm = ALGORITHMS[i];
+        const char *name = ALGORITHM_NAMES[i];
+        for (j = 0; j < pool_sizes.size(); j++)
+        {
+            ProcessPool pool(pool_sizes[j], algorithm, rng);
+            json.result("queue_push_pop", name, 0, pool_sizes[j], "ns_per_op",
+                        benchQueue(algorithm, pool, operations));
+            if (algorithm == SJF)
+            {
+                json.result("comparator", name, 0, pool_sizes[j], "ns_per_op",
+                            benchComparator<SjfComparator>(pool, operations));
+            }
+            else if (algorithm == PP)
+            {
+                json.result("comparator", name, 0, pool_sizes[j], "ns_per_op",
+                            benchComparator<PpComparator>(pool, operations));
+            }
+            for (k = 0; k < core_counts.size(); k++)
+            {
+                json.result("dispatch", name, core_counts[k], pool_sizes[j], "median_ns",
+                            benchDispatch(algorithm, core_counts[k], pool, samples));
+            }
+        }
+        for (j = 0; j < sim_sizes.size(); j++)
+        {
+            for (k = 0; k < core_counts.size(); k++)
+            {
+                json.result("simulate", name, core_counts[k], sim_sizes[j], "events_per_sec",
+                            benchSimulate(algorithm, core_counts[k], sim_sizes[j], rng));
+            }
+        }
+    }
+    json.finish();
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,408 @@
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "configreader.h"
+#include "workloadfile.h"
+
+// Synthetic workload generator: writes a config in the text format (or the
+// binary workload format) with randomly drawn arrivals, bursts and priorities.
+// Processes are generated and written one at a time, so the process count is
+// limited only by disk space. All randomness comes from one seeded
+// xorshift64* stream with hand-written samplers, so a seed gives the same
+// workload on every platform.
+
+typedef struct GeneratorOptions {
+    uint64_t processes;
+    uint32_t cores;
+    std::vector<double> core_speeds;    // empty: every core at base speed
+    ScheduleAlgorithm algorithm;
+    uint32_t context_switch;
+    uint32_t time_slice;
+    std::string arrivals;       // poisson | bursty
+    double rate;                // mean arrivals per second
+    double group_size;          // bursty: mean arrivals per group
+    std::string cpu_dist;       // exponential | bimodal | heavy
+    double cpu_mean;            // ms
+    std::string io_dist;
+    double io_mean;             // ms
+    double bursts;              // mean CPU bursts per process
+    std::vector<double> priority_weights;
+    uint64_t seed;
+    bool binary;
+    const char *output;
+} GeneratorOptions;
+
+class Random {
+private:
+    uint64_t state;
+
+public:
+    Random(uint64_t seed)
+    {
+        // splitmix64 step so small seeds still give a well-mixed state
+        uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        state = (z ^ (z >> 31)) | 1;
+    }
+
+    uint64_t next()
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1Dull;
+    }
+
+    // uniform in (0, 1]
+    double uniform()
+    {
+        return ((next() >> 11) + 1) * (1.0 / 9007199254740992.0);
+    }
+
+    double exponential(double mean)
+    {
+        return -mean * log(uniform());
+    }
+};
+
+// Burst length (ms, at least 1) with the given distribution and mean
+//   exponential: memoryless
+//   bimodal: 80% short (half the mean) and 20% long (three times the mean)
+//   heavy: Pareto with shape 1.5, capped at 1000 times the mean
+uint32_t drawBurst(Random& rng, const std::string& dist, double mean)
+{
+    double value;
+    if (dist == "bimodal")
+    {
+        value = (rng.uniform() <= 0.8) ? rng.exponential(mean * 0.5) : rng.exponential(mean * 3.0);
+    }
+    else if (dist == "heavy")
+    {
+        const double shape = 1.5;
+        double scale = mean * (shape - 1.0) / shape;
+        value = scale / pow(rng.uniform(), 1.0 / shape);
+        value = (value < mean * 1000.0) ? value : mean * 1000.0;
+    }
+    else
+    {
+        value = rng.exponential(mean);
+    }
+    return (value < 1.0) ? 1 : (value > UINT32_MAX) ? UINT32_MAX : (uint32_t)llround(value);
+}
+
+uint8_t drawPriority(Random& rng, const std::vector<double>& cumulative)
+{
+    size_t i;
+    double u = rng.uniform() * cumulative.back();
+    for (i = 0; i + 1 < cumulative.size() && u > cumulative[i]; i++)
+    {
+    }
+    return i;
+}
+
+// Arrival times: poisson spaces every arrival exponentially at `rate`;
+// bursty sends arrivals in groups (geometric size, 1 ms apart) with
+// exponential gaps between groups sized to keep the same average rate
+class ArrivalProcess {
+private:
+    Random& rng;
+    const GeneratorOptions& options;
+    double time;
+    bool first;
+
+public:
+    ArrivalProcess(Random& rng, const GeneratorOptions& options) : rng(rng), options(options)
+    {
+        time = 0.0;
+        first = true;
+    }
+
+    uint32_t next()
+    {
+        double mean_gap = 1000.0 / options.rate;
+        if (first)
+        {
+            first = false;
+        }
+        else if (options.arrivals == "bursty")
+        {
+            bool new_group = rng.uniform() <= 1.0 / options.group_size;
+            time += new_group ? rng.exponential(mean_gap * options.group_size) : rng.exponential(1.0);
+        }
+        else
+        {
+            time += rng.exponential(mean_gap);
+        }
+        return (time < UINT32_MAX) ? (uint32_t)time : UINT32_MAX;
+    }
+};
+
+bool parseWeights(const char *text, std::vector<double>& weights)
+{
+    weights.clear();
+    while (*text != '\0')
+    {
+        char *end;
+        double w = strtod(text, &end);
+        if (end == text || w < 0.0)
+        {
+            return false;
+        }
+        weights.push_back(w);
+        text = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0')
+        {
+            return false;
+        }
+    }
+    return !weights.empty() && weights.size() <= 256;
+}
+
+bool parseAlgorithm(const char *text, ScheduleAlgorithm *algorithm)
+{
+    if      (strcmp(text, "FCFS") == 0) *algorithm = ScheduleAlgorithm::FCFS;
+    else if (strcmp(text, "SJF") == 0)  *algorithm = ScheduleAlgorithm::SJF;
+    else if (strcmp(text, "RR") == 0)   *algorithm = ScheduleAlgorithm::RR;
+    else if (strcmp(text, "PP") == 0)   *algorithm = ScheduleAlgorithm::PP;
+    else if (strcmp(text, "MLFQ") == 0) *algorithm = ScheduleAlgorithm::MLFQ;
+    else if (strcmp(text, "CFS") == 0)  *algorithm = ScheduleAlgorithm::CFS;
+    else return false;
+    return true;
+}
+
+const char* algorithmName(ScheduleAlgorithm algorithm)
+{
+    static const char *names[] = { "FCFS", "SJF", "RR", "PP", "MLFQ", "CFS" };
+    return names[algorithm];
+}
+
+bool isDistribution(const std::string& name)
+{
+    return name == "exponential" || name == "bimodal" || name == "heavy";
+}
+
+void usage()
+{
+    std::cerr <<
+        "Usage: workloadgen [options]\n"
+        "  --processes=N           number of processes (default 1000)\n"
+        "  --cores=N               cpu cores (default 4)\n"
+        "  --core-speeds=S0,S1,... speed factor of each core (default all 1)\n"
+        "  --algorithm=NAME        FCFS, SJF, RR, PP, MLFQ or CFS (default RR)\n"
+        "  --context-switch=MS     context switch time (default 50)\n"
+        "  --time-slice=MS         time slice (default 200)\n"
+        "  --arrivals=KIND         poisson or bursty (default poisson)\n"
+        "  --rate=R                mean arrivals per second (default 10)\n"
+        "  --group-size=N          bursty: mean arrivals per group (default 20)\n"
+        "  --cpu=DIST              exponential, bimodal or heavy (default exponential)\n"
+        "  --cpu-mean=MS           mean CPU burst (default 1000)\n"
+        "  --io=DIST               I/O burst distribution (default exponential)\n"
+        "  --io-mean=MS            mean I/O burst (default 1000)\n"
+        "  --bursts=N              mean CPU bursts per process (default 3)\n"
+        "  --priorities=W0,W1,...  relative weight of each priority (default 1,1,1,1,1)\n"
+        "  --seed=N                random seed (default 1)\n"
+        "  --binary                write the binary workload format (needs --output)\n"
+        "  --output=FILE           output file (default: standard output)\n";
+}
+
+bool parseOptions(int argc, char **argv, GeneratorOptions& options)
+{
+    int a;
+    options.processes = 1000;
+    options.cores = 4;
+    options.algorithm = ScheduleAlgorithm::RR;
+    options.context_switch = 50;
+    options.time_slice = 200;
+    options.arrivals = "poisson";
+    options.rate = 10.0;
+    options.group_size = 20.0;
+    options.cpu_dist = "exponential";
+    options.cpu_mean = 1000.0;
+    options.io_dist = "exponential";
+    options.io_mean = 1000.0;
+    options.bursts = 3.0;
+    options.priority_weights.assign(5, 1.0);
+    options.seed = 1;
+    options.binary = false;
+    options.output = NULL;
+
+    for (a = 1; a < argc; a++)
+    {
+        const char *arg = argv[a];
+        const char *value = strchr(arg, '=');
+        std::string name = (value != NULL) ? std::string(arg, value - arg) : std::string(arg);
+        value = (value != NULL) ? value + 1 : "";
+        bool ok = true;
+        if      (name == "--processes")      options.processes = strtoull(value, NULL, 10);
+        else if (name == "--cores")          options.cores = strtoul(value, NULL, 10);
+        else if (name == "--core-speeds")    ok = parseWeights(value, options.core_speeds);
+        else if (name == "--algorithm")      ok = parseAlgorithm(value, &options.algorithm);
+        else if (name == "--context-switch") options.context_switch = strtoul(value, NULL, 10);
+        else if (name == "--time-slice")     options.time_slice = strtoul(value, NULL, 10);
+        else if (name == "--arrivals")       options.arrivals = value;
+        else if (name == "--rate")           options.rate = strtod(value, NULL);
+        else if (name == "--group-size")     options.group_size = strtod(value, NULL);
+        else if (name == "--cpu")            options.cpu_dist = value;
+        else if (name == "--cpu-mean")       options.cpu_mean = strtod(value, NULL);
+        else if (name == "--io")             options.io_dist = value;
+        else if (name == "--io-mean")        options.io_mean = strtod(value, NULL);
+        else if (name == "--bursts")         options.bursts = strtod(value, NULL);
+        else if (name == "--priorities")     ok = parseWeights(value, options.priority_weights);
+        else if (name == "--seed")           options.seed = strtoull(value, NULL, 10);
+        else if (name == "--binary")         options.binary = true;
+        else if (name == "--output")         options.output = value;
+        else if (name == "--help")           return false;
+        else ok = false;
+        if (!ok)
+        {
+            std::cerr << "Error: bad option " << arg << std::endl;
+            return false;
+        }
+    }
+
+    const char *problem = NULL;
+    if (options.cores < 1 || options.cores > MAX_CORES) problem = "--cores must be 1-32767";
+    else if (!options.core_speeds.empty() && options.core_speeds.size() != options.cores) problem = "--core-speeds needs one speed per core";
+    else if (std::count(options.core_speeds.begin(), options.core_speeds.end(), 0.0) > 0) problem = "--core-speeds must be positive";
+    else if (options.arrivals != "poisson" && options.arrivals != "bursty") problem = "--arrivals must be poisson or bursty";
+    else if (!isDistribution(options.cpu_dist) || !isDistribution(options.io_dist)) problem = "--cpu/--io must be exponential, bimodal or heavy";
+    else if (options.rate <= 0.0 || options.group_size < 1.0) problem = "--rate must be positive and --group-size at least 1";
+    else if (options.cpu_mean < 1.0 || options.io_mean < 1.0 || options.bursts < 1.0) problem = "burst means and --bursts must be at least 1";
+    else if (options.binary && options.output == NULL) problem = "--binary needs --output";
+    if (problem != NULL)
+    {
+        std::cerr << "Error: " << problem << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t i;
+    uint32_t j;
+    GeneratorOptions options;
+    if (!parseOptions(argc, argv, options))
+    {
+        usage();
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<double> cumulative;
+    double total = 0.0;
+    for (j = 0; j < options.priority_weights.size(); j++)
+    {
+        total += options.priority_weights[j];
+        cumulative.push_back(total);
+    }
+    if (total <= 0.0)
+    {
+        std::cerr << "Error: --priorities needs a positive weight" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<uint16_t> core_speeds;
+    for (j = 0; j < options.core_speeds.size(); j++)
+    {
+        core_speeds.push_back(std::min(options.core_speeds[j] * BASE_CORE_SPEED + 0.5, (double)UINT16_MAX));
+    }
+
+    std::string error;
+    WorkloadWriter writer;
+    FILE *out = NULL;
+    if (options.binary)
+    {
+        if (!writer.open(options.output, options.cores, options.algorithm, options.context_switch,
+                         options.time_slice, core_speeds.data(), core_speeds.size(), error))
+        {
+            std::cerr << "Error: " << options.output << ": " << error << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    else
+    {
+        out = (options.output != NULL) ? fopen(options.output, "w") : stdout;
+        if (out == NULL)
+        {
+            std::cerr << "Error: cannot create " << options.output << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        setvbuf(out, NULL, _IOFBF, 1 << 20);
+        fprintf(out, "%u", options.cores);
+        for (j = 0; j < core_speeds.size(); j++)
+        {
+            fprintf(out, " %u.%03u", core_speeds[j] / BASE_CORE_SPEED, core_speeds[j] % BASE_CORE_SPEED);
+        }
+        fprintf(out, "\n%s\n%u\n%u\n%" PRIu64 "\n", algorithmName(options.algorithm),
+                options.context_switch, options.time_slice, options.processes);
+    }
+
+    // number of CPU bursts is geometric with the requested mean (at most
+    // 32768, so a process never has more than 65535 bursts in total)
+    Random rng(options.seed);
+    ArrivalProcess arrivals(rng, options);
+    std::vector<uint32_t> bursts;
+    for (i = 0; i < options.processes; i++)
+    {
+        uint32_t start_time = arrivals.next();
+        uint32_t cpu_bursts = 1;
+        while (cpu_bursts < 32768 && rng.uniform() > 1.0 / options.bursts)
+        {
+            cpu_bursts++;
+        }
+        bursts.clear();
+        for (j = 0; j < cpu_bursts; j++)
+        {
+            if (j > 0)
+            {
+                bursts.push_back(drawBurst(rng, options.io_dist, options.io_mean));
+            }
+            bursts.push_back(drawBurst(rng, options.cpu_dist, options.cpu_mean));
+        }
+        uint8_t priority = drawPriority(rng, cumulative);
+        uint32_t pid = (uint32_t)(i + 1);
+
+        if (options.binary)
+        {
+            if (!writer.add(pid, start_time, priority, bursts.data(), bursts.size(), error))
+            {
+                std::cerr << "Error: " << options.output << ": " << error << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+        else
+        {
+            fprintf(out, "%u,%u,", pid, start_time);
+            for (j = 0; j < bursts.size(); j++)
+            {
+                fprintf(out, (j == 0) ? "%u" : "|%u", bursts[j]);
+            }
+            fprintf(out, ",%u\n", priority);
+        }
+    }
+
+    bool ok;
+    if (options.binary)
+    {
+        ok = writer.close(error);
+    }
+    else
+    {
+        ok = (fflush(out) == 0 && !ferror(out));
+        error = "write failed";
+        if (out != stdout && fclose(out) != 0)
+        {
+            ok = false;
+        }
+    }
+    if (!ok)
+    {
+        std::cerr << "Error: " << (options.output != NULL ? options.output : "stdout") << ": " << error << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return EXIT_SUCCESS;
+}